@@ -4,6 +4,9 @@
 #include <deque>
 #include <algorithm>
 #include <math.h>
+#include <chrono>
+#include "src/log.h"
+#include "src/programregistry.h"
 
 // vertex shader in GLSL: It is a Raw string (C++11) since it contains new line characters
 const char * const vertexSource = R"(
@@ -30,7 +33,39 @@ const char * const fragmentSource = R"(
 		outColor = vec4(color, 1);	// computed color is the color of the primitive
 	}
 )";
-GPUProgram gpuProgram; // vertex and fragment shaders
+ShaderProgram gpuProgram; // vertex and fragment shaders
+
+// vertex shader of textured quads
+const char * const texturedVertexSource = R"(
+	#version 330				// Shader 3.3
+	precision highp float;		// normal floats, makes no difference on desktop computers
+
+	uniform mat4 MVP;			// uniform variable, the Model-View-Projection transformation matrix
+	layout(location = 0) in vec2 vp;	// Varying input: vp = vertex position is expected in attrib array 0
+	layout(location = 1) in vec2 vertexUV;	// Varying input: texture coordinate is expected in attrib array 1
+
+	out vec2 texCoord;			// output attribute, interpolated for the fragments
+
+	void main() {
+		texCoord = vertexUV;
+		gl_Position = vec4(vp.x, vp.y, 0, 1) * MVP;		// transform vp from modeling space to normalized device space
+	}
+)";
+
+// fragment shader of textured quads
+const char * const texturedFragmentSource = R"(
+	#version 330			// Shader 3.3
+	precision highp float;	// normal floats, makes no difference on desktop computers
+
+	uniform sampler2D textureUnit;	// the texture of the primitive
+	in vec2 texCoord;		// interpolated texture coordinate
+	out vec4 outColor;		// computed color of the current pixel
+
+	void main() {
+		outColor = texture(textureUnit, texCoord);
+	}
+)";
+ShaderProgram texturedProgram; // cached layers
 
 vec4 asvec4(vec2 v) {
     return vec4(v.x, v.y, 0, 1);
@@ -40,63 +75,114 @@ vec2 asvec2(vec4 v) {
     return vec2(v.x, v.y);
 }
 
+#include "src/streambuffer.h"
+// Per frame geometry of the drawers goes here
+StreamBuffer * streamBuffer;
+
+#include "src/framepacer.h"
+#include "src/renderbackend.h"
+#include "src/glrenderbackend.h"
 #include "src/camera.h"
+#include "src/splinebasis.h"
 #include "src/spline.h"
+#include "src/cachedbgdrawer.h"
 #include "src/circle.h"
+#include "src/simulation.h"
+#include "src/profiler.h"
+#include "src/overlay.h"
 
 Camera camera(
     vec2(windowWidth/2, windowHeight/2), // set center so that (0,0) is the bottom left corner
     windowWidth, windowHeight);
 
+GlRenderBackend * glBackend;
 Spline * ground;
 GroundDrawer * groundDrawer;
-Spline * bg;
+BgSpline * bg;
 BgDrawer * bgDrawer;
 Circle * circle;
 CircleDrawer * circleDraw;
 CircleController * circleControl;
+// Owns circle and circleControl once started, reads ground
+Simulation * simulation;
+// One simulation step and at most one redraw per frame
+FramePacer framePacer(20);
+// Cost of the passes of onDisplay, shown by the overlay (key 'o')
+Profiler * profiler;
+PerfOverlay * overlay;
 
 
 // Initialization, create an OpenGL context
 void onInitialization() {
     glViewport(0, 0, windowWidth, windowHeight);
 
-    // create program for the GPU
-    gpuProgram.Create(vertexSource, fragmentSource, "outColor");
+    // create programs for the GPU, cold runs compile them, warm runs load the cached binaries
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    ProgramRegistry * programRegistry = new ProgramRegistry();
+    if (!programRegistry->load(texturedProgram, texturedVertexSource, texturedFragmentSource, "outColor") ||
+        !programRegistry->load(gpuProgram, vertexSource, fragmentSource, "outColor")) {
+        printf("Error in shader program creation\n");
+        exit(1);
+    }
+    printf("Shader programs ready in %.2f ms\n",
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    streamBuffer = new StreamBuffer();
+    glBackend = new GlRenderBackend(&gpuProgram, streamBuffer);
     ground = new Spline(vec2(0,windowHeight/2), vec2(windowWidth, windowHeight/2), -0.1);
-    groundDrawer = new GroundDrawer(ground);
+    groundDrawer = new GroundDrawer(glBackend);
     circle = new Circle(vec2(10, 400), 30);
-    circleDraw = new CircleDrawer(circle);
+    circleDraw = new CircleDrawer(glBackend);
     circleControl = new CircleController(circle, ground);
-    bg = new Spline(vec2(0,2*windowHeight/3), vec2(windowWidth, 3*windowHeight/4), 1.5);
+    bg = new BgSpline(vec2(0,2*windowHeight/3), vec2(windowWidth, 3*windowHeight/4));
     bg->add(vec2(150, 550));
     bg->add(vec2(300, 500));
     bg->add(vec2(450, 575));
-    bgDrawer = new BgDrawer(bg);
+    bgDrawer = new CachedBgDrawer(bg, glBackend, &texturedProgram);
+    simulation = new Simulation(ground, circle, circleControl);
+    profiler = new Profiler(glBackend, streamBuffer);
+    overlay = new PerfOverlay(glBackend);
 }
 
 // Window has become invalid: Redraw
 void onDisplay() {
+    profiler->beginFrame();
     glClearColor(0, 0, 0, 0);     // background color
     glClear(GL_COLOR_BUFFER_BIT); // clear frame buffer
 
     // Set color to (0, 1, 0) = green
     int location = glGetUniformLocation(gpuProgram.getId(), "color");
     glUniform3f(location, 0.0f, 1.0f, 0.0f); // 3 floats
-    location = glGetUniformLocation(gpuProgram.getId(), "MVP");	// Get the GPU location of uniform variable MVP
-    glUniformMatrix4fv(location, 1, GL_TRUE, &camera.getMatrix().m[0][0]);	// Load a 4x4 row-major float matrix to the specified location
+    mat4 viewProjection = camera.getMatrix();
+    glBackend->setViewProjection(viewProjection);
 
-    bgDrawer->draw();
-    groundDrawer->draw();
-    circleDraw->draw();
-
-    glutSwapBuffers(); // exchange buffers for double buffering
+    // The layer follows the camera of this frame, a redraw may be the only one after a camera move
     bg->transformationMatrix = mat4(
             1,0,0,0,
             0,1,0,0,
             0,0,0,0,
             camera.center.x - 300, camera.center.y - 300,0,1
             );
+
+    streamBuffer->beginFrame();
+    profiler->begin(Profiler::BACKGROUND);
+    bgDrawer->draw(viewProjection);
+    profiler->end(Profiler::BACKGROUND);
+    // Only uploads and draws here, the vertices were made by the simulation thread
+    profiler->begin(Profiler::SCENE);
+    const FrameSnapshot & snapshot = simulation->acquire();
+    groundDrawer->draw(snapshot.groundVertices);
+    circleDraw->draw(snapshot.circleVertices);
+    simulation->release();
+    profiler->end(Profiler::SCENE);
+    if (overlay->visible) {
+        profiler->begin(Profiler::OVERLAY);
+        overlay->draw(*profiler);
+        profiler->end(Profiler::OVERLAY);
+    }
+    streamBuffer->endFrame();
+    profiler->endFrame();
+
+    glutSwapBuffers(); // exchange buffers for double buffering
 }
 
 // Key of ASCII code pressed
@@ -104,8 +190,17 @@ void onKeyboard(unsigned char key, int pX, int pY) {
     if (key == 'd') { 
     }
     if (key == ' ') {
-        camera.center = asvec2( circle->center );
-
+        camera.center = simulation->acquire().circleCenter;
+        simulation->release();
+        framePacer.invalidate();
+    }
+    if (key == 's') {
+        framePacer.printStatistics();
+        framePacer.resetStatistics();
+    }
+    if (key == 'o') {
+        overlay->visible = !overlay->visible;
+        framePacer.invalidate();
     }
 }
 
@@ -118,7 +213,7 @@ void onMouseMotion(int pX, int pY) {	// pX, pY are the pixel coordinates of the
 	// Convert to normalized device space
 	float cX = 2.0f * pX / windowWidth - 1;	// flip y axis
 	float cY = 1.0f - 2.0f * pY / windowHeight;
-	printf("Mouse moved to (%3.2f, %3.2f)\n", cX, cY);
+	LOG_DEBUG("Mouse moved to (%3.2f, %3.2f)", cX, cY);
 }
 
 // Mouse click event
@@ -127,33 +222,38 @@ void onMouse(int button, int state, int pX, int pY) { // pX, pY are the pixel co
 	float cX = 2.0f * pX / windowWidth - 1;	// flip y axis
 	float cY = 1.0f - 2.0f * pY / windowHeight;
 
-	char * buttonStat;
+	const char * buttonStat = "";
 	switch (state) {
 	case GLUT_DOWN: buttonStat = "pressed"; break;
 	case GLUT_UP:   buttonStat = "released"; break;
 	}
 
 	switch (button) {
-	case GLUT_LEFT_BUTTON:   printf("Left button %s at (%3.2f, %3.2f)\n", buttonStat, cX, cY);   break;
-	case GLUT_MIDDLE_BUTTON: printf("Middle button %s at (%3.2f, %3.2f)\n", buttonStat, cX, cY); break;
-	case GLUT_RIGHT_BUTTON:  printf("Right button %s at (%3.2f, %3.2f)\n", buttonStat, cX, cY);  break;
+	case GLUT_LEFT_BUTTON:   LOG_INFO("Left button %s at (%3.2f, %3.2f)", buttonStat, cX, cY);   break;
+	case GLUT_MIDDLE_BUTTON: LOG_INFO("Middle button %s at (%3.2f, %3.2f)", buttonStat, cX, cY); break;
+	case GLUT_RIGHT_BUTTON:  LOG_INFO("Right button %s at (%3.2f, %3.2f)", buttonStat, cX, cY);  break;
 	}
 	vec4 v4newPoint = asvec4(vec2(cX, cY));
 	v4newPoint = v4newPoint * camera.getInversMatrix();
 	vec2 v2newPoint = asvec2(v4newPoint);
-	if (state == GLUT_DOWN) ground->add(v2newPoint);
+	if (state == GLUT_DOWN) {
+	    // Published at once, the simulation draws it from its next step on
+	    ground->add(v2newPoint);
+	}
 }
 
 // Idle event indicating that some time elapsed: do animation here
 void onIdle() {
-	long time = glutGet(GLUT_ELAPSED_TIME); // elapsed time since the start of the program
-        static long prev_time = time;
-
-        if (time - prev_time > 50) {
-
-            glutPostRedisplay();         // if d, invalidate display, i.e. redraw
-            circleControl->tick();
+	// Sleeps until the frame is due instead of spinning on the clock
+	framePacer.waitForNextFrame();
 
-            prev_time = time;
-        }
+	// Draw what the simulation has published, and let it prepare the next frame meanwhile
+	if (simulation->poll()) framePacer.invalidate();
+	// The overlay shows the cost of every frame, so every frame is drawn
+	if (overlay->visible) framePacer.invalidate();
+	// The wheel follows the zoom of the camera
+	simulation->setLodParameters(camera.getPixelsPerUnit());
+	simulation->requestStep();
+	// Nothing changed, nothing to draw
+	if (framePacer.needsRedraw()) glutPostRedisplay();
 }
@@ -0,0 +1,264 @@
+// End-to-end scaling scenarios: builds scenes with the real Spline, Circle
+// and drawer classes, runs a fixed number of frames and reports the
+// p50/p95/p99 time of every phase.
+//
+// usage: scenarioRunner [--points 10,1000,...] [--bodies 1,100,...]
+//                       [--frames N] [--format csv|json] [--gl]
+//
+// Without --points/--bodies the ground grows from 10 to 10^6 points with
+// one body, then the bodies grow from 1 to 10^5 on a 10 point ground.
+// --gl also times uploading and drawing. It needs a display, on a headless
+// host run it through Mesa, e.g. xvfb-run -a ./scenarioRunner --gl
+#include "../framework.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+vec4 asvec4(vec2 v) {
+    return vec4(v.x, v.y, 0, 1);
+}
+
+vec2 asvec2(vec4 v) {
+    return vec2(v.x, v.y);
+}
+
+// The shader of Skeleton.cpp
+const char * const vertexSource = R"(
+	#version 330
+	precision highp float;
+	uniform mat4 MVP;
+	layout(location = 0) in vec2 vp;
+	void main() {
+		gl_Position = vec4(vp.x, vp.y, 0, 1) * MVP;
+	}
+)";
+
+const char * const fragmentSource = R"(
+	#version 330
+	precision highp float;
+	uniform vec3 color;
+	out vec4 outColor;
+	void main() {
+		outColor = vec4(color, 1);
+	}
+)";
+
+#include "../src/log.h"
+#include "../src/programregistry.h"
+#include "../src/streambuffer.h"
+ShaderProgram gpuProgram;
+ShaderProgram texturedProgram;
+StreamBuffer * streamBuffer;
+
+#include "../src/renderbackend.h"
+#include "../src/glrenderbackend.h"
+#include "../src/camera.h"
+#include "../src/splinebasis.h"
+#include "../src/spline.h"
+#include "../src/circle.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Phase {
+    const char * name;
+    std::vector<double> times; // ms, one per frame
+
+    // Nearest rank percentile
+    double percentile(double p) {
+        std::vector<double> sorted = times;
+        std::sort(sorted.begin(), sorted.end());
+        int rank = (int) ceil(p / 100 * sorted.size());
+        if (rank < 1) rank = 1;
+        return sorted[rank - 1];
+    }
+};
+
+struct Result {
+    int points;
+    int bodies;
+    std::vector<Phase> phases;
+};
+
+GlRenderBackend * glBackend;
+
+static Result runScenario(int points, int bodies, int frames, bool gl) {
+    Result result;
+    result.points = points;
+    result.bodies = bodies;
+
+    // The scene
+    Spline ground(vec2(0, windowHeight / 2), vec2(windowWidth, windowHeight / 2), -0.1);
+    std::vector<vec2> controlPoints;
+    srand(points);
+    for (int i = 0; i < points; i++) {
+        float x = (i + 0.5f) * windowWidth / points;
+        controlPoints.push_back(vec2(x, windowHeight / 4 + rand() % (windowHeight / 2)));
+    }
+    ground.add(controlPoints);
+
+    std::vector<Circle *> circles;
+    std::vector<CircleController *> controllers;
+    for (int i = 0; i < bodies; i++) {
+        Circle * circle = new Circle(vec2(30 + (i * 7919) % (windowWidth - 60), 400), 30);
+        circles.push_back(circle);
+        controllers.push_back(new CircleController(circle, &ground, i % 2 == 0));
+    }
+
+    GroundDrawer * groundDrawer = gl ? new GroundDrawer(glBackend) : NULL;
+    CircleDrawer * circleDrawer = gl ? new CircleDrawer(glBackend) : NULL;
+    std::vector<float> groundVertices;
+    std::vector<std::vector<float> > circleVertices(bodies);
+
+    Phase tick = { "tick" }, groundGen = { "ground_vertices" }, circleGen = { "circle_vertices" },
+          render = { "render" }, frame = { "frame" };
+    for (int f = 0; f < frames; f++) {
+        Clock::time_point frameStart = Clock::now();
+
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < bodies; i++) controllers[i]->tick();
+        tick.times.push_back(msSince(start));
+
+        start = Clock::now();
+        GroundDrawer::generate(&ground, groundVertices);
+        groundGen.times.push_back(msSince(start));
+
+        start = Clock::now();
+        for (int i = 0; i < bodies; i++) CircleDrawer::generate(circles[i], circleVertices[i]);
+        circleGen.times.push_back(msSince(start));
+
+        if (gl) {
+            start = Clock::now();
+            glClear(GL_COLOR_BUFFER_BIT);
+            streamBuffer->beginFrame();
+            groundDrawer->draw(groundVertices);
+            for (int i = 0; i < bodies; i++) circleDrawer->draw(circleVertices[i]);
+            streamBuffer->endFrame();
+            glFinish();
+            render.times.push_back(msSince(start));
+        }
+        frame.times.push_back(msSince(frameStart));
+    }
+
+    result.phases.push_back(tick);
+    result.phases.push_back(groundGen);
+    result.phases.push_back(circleGen);
+    if (gl) result.phases.push_back(render);
+    result.phases.push_back(frame);
+
+    for (int i = 0; i < bodies; i++) {
+        delete controllers[i];
+        delete circles[i];
+    }
+    delete groundDrawer;
+    delete circleDrawer;
+    return result;
+}
+
+static std::vector<int> parseList(const char * text) {
+    std::vector<int> list;
+    std::string item;
+    for (const char * c = text; ; c++) {
+        if (*c == ',' || *c == 0) {
+            if (!item.empty()) list.push_back(atoi(item.c_str()));
+            item.clear();
+            if (*c == 0) break;
+        } else {
+            item += *c;
+        }
+    }
+    return list;
+}
+
+static void initGl(int argc, char * argv[]) {
+    glutInit(&argc, argv);
+#if !defined(__APPLE__)
+    glutInitContextVersion(3, 3);
+#endif
+    glutInitWindowSize(windowWidth, windowHeight);
+#if defined(__APPLE__)
+    glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE | GLUT_3_2_CORE_PROFILE);
+#else
+    glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE);
+#endif
+    glutCreateWindow("scenarioRunner");
+    glutHideWindow();
+#if !defined(__APPLE__)
+    glewExperimental = true;
+    glewInit();
+#endif
+    glViewport(0, 0, windowWidth, windowHeight);
+    ProgramRegistry * programRegistry = new ProgramRegistry();
+    if (!programRegistry->load(gpuProgram, vertexSource, fragmentSource, "outColor")) exit(1);
+    streamBuffer = new StreamBuffer();
+    glBackend = new GlRenderBackend(&gpuProgram, streamBuffer);
+    Camera camera(vec2(windowWidth / 2, windowHeight / 2), windowWidth, windowHeight);
+    glBackend->setViewProjection(camera.getMatrix());
+}
+
+int main(int argc, char * argv[]) {
+    std::vector<int> pointCounts, bodyCounts;
+    int frames = 100;
+    bool json = false, gl = false, ok = true;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--points") && i + 1 < argc) pointCounts = parseList(argv[++i]);
+        else if (!strcmp(argv[i], "--bodies") && i + 1 < argc) bodyCounts = parseList(argv[++i]);
+        else if (!strcmp(argv[i], "--frames") && i + 1 < argc) frames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--format") && i + 1 < argc) json = !strcmp(argv[++i], "json");
+        else if (!strcmp(argv[i], "--gl")) gl = true;
+        else {
+            ok = false;
+            break;
+        }
+    }
+    // The percentiles need at least one frame (atoi gives 0 for a non-number too)
+    if (!ok || frames < 1) {
+        fprintf(stderr, "usage: %s [--points 10,1000] [--bodies 1,100] [--frames N] [--format csv|json] [--gl]\n", argv[0]);
+        return 1;
+    }
+    if (gl) initGl(argc, argv);
+
+    // The scenarios: every (points, bodies) pair, or the two default sweeps
+    std::vector<std::pair<int, int> > scenarios;
+    if (pointCounts.empty() && bodyCounts.empty()) {
+        for (int points = 10; points <= 1000000; points *= 10) scenarios.push_back(std::make_pair(points, 1));
+        for (int bodies = 10; bodies <= 100000; bodies *= 10) scenarios.push_back(std::make_pair(10, bodies));
+    } else {
+        if (pointCounts.empty()) pointCounts.push_back(10);
+        if (bodyCounts.empty()) bodyCounts.push_back(1);
+        for (int p = 0; p < pointCounts.size(); p++) {
+            for (int b = 0; b < bodyCounts.size(); b++) scenarios.push_back(std::make_pair(pointCounts[p], bodyCounts[b]));
+        }
+    }
+
+    if (json) printf("[\n");
+    else printf("points,bodies,phase,frames,p50_ms,p95_ms,p99_ms\n");
+    bool first = true;
+    for (int s = 0; s < scenarios.size(); s++) {
+        Result result = runScenario(scenarios[s].first, scenarios[s].second, frames, gl);
+        for (int p = 0; p < result.phases.size(); p++) {
+            Phase & phase = result.phases[p];
+            if (json) {
+                printf("%s  {\"points\": %d, \"bodies\": %d, \"phase\": \"%s\", \"frames\": %d, "
+                       "\"p50_ms\": %.6f, \"p95_ms\": %.6f, \"p99_ms\": %.6f}",
+                       first ? "" : ",\n", result.points, result.bodies, phase.name, frames,
+                       phase.percentile(50), phase.percentile(95), phase.percentile(99));
+            } else {
+                printf("%d,%d,%s,%d,%.6f,%.6f,%.6f\n", result.points, result.bodies, phase.name, frames,
+                       phase.percentile(50), phase.percentile(95), phase.percentile(99));
+            }
+            first = false;
+        }
+        fflush(stdout);
+    }
+    if (json) printf("\n]\n");
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Cost of building the segments of a Spline for every basis in
+// splinebasis.h, which is the only place the basis runs (queries evaluate
+// the cached coefficients), and of the queries: r, the arc length
+// conversions and pinning a version of the curve
+//
+// usage: splineBench [control points] [evaluations]
+#include "../src/vecmath.h"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+
+vec4 asvec4(vec2 v) {
+    return vec4(v.x, v.y, 0, 1);
+}
+
+vec2 asvec2(vec4 v) {
+    return vec2(v.x, v.y);
+}
+
+#include "../src/log.h"
+#include "../src/renderbackend.h"
+#include "../src/camera.h"
+#include "../src/splinebasis.h"
+#include "../src/spline.h"
+
+// One point per slot in random order, so no two share an x
+std::vector<vec2> randomPoints(int points) {
+    std::vector<vec2> cPoints;
+    srand(1);
+    float slot = (windowWidth - 2.0f) / points;
+    for (int i = 0; i < points; i++) {
+        cPoints.push_back(vec2(1 + slot * (i + (rand() + 1.0f) / (RAND_MAX + 2.0f)), rand() % windowHeight));
+    }
+    std::random_shuffle(cPoints.begin(), cPoints.end());
+    return cPoints;
+}
+
+template <class Basis>
+void bench(const char * name, Basis basis, int points, int evaluations) {
+    std::vector<vec2> cPoints = randomPoints(points);
+    int rebuilds = evaluations / 100 / points + 1;
+
+    // Every segment at once, add(vector) rebuilds all of them
+    float sum = 0; // keeps the compiler from dropping the loop
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rebuilds; i++) {
+        BasicSpline<Basis> spline(vec2(0, windowHeight / 2), vec2(windowWidth, windowHeight / 2), basis);
+        spline.add(cPoints);
+        sum += spline.totalArcLength();
+    }
+    std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+    double segmentNs = std::chrono::duration<double, std::nano>(stop - start).count() / rebuilds / (points + 1);
+
+    // One point at a time, add(point) rebuilds the four segments around it
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rebuilds; i++) {
+        BasicSpline<Basis> spline(vec2(0, windowHeight / 2), vec2(windowWidth, windowHeight / 2), basis);
+        for (int p = 0; p < points; p++) spline.add(cPoints[p]);
+        sum += spline.totalArcLength();
+    }
+    stop = std::chrono::steady_clock::now();
+    double addNs = std::chrono::duration<double, std::nano>(stop - start).count() / rebuilds / points;
+
+    printf("%-28s %8.2f ns/segment rebuilt %8.2f ns/point added   (checksum %g)\n", name, segmentNs, addNs, sum);
+}
+
+void benchQueries(int points, int evaluations) {
+    Spline spline(vec2(0, windowHeight / 2), vec2(windowWidth, windowHeight / 2), -0.1);
+    spline.add(randomPoints(points));
+
+    // The same for every basis, only the cached coefficients are evaluated
+    float sum = 0;
+    Spline::Reader shape = spline.read();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < evaluations; i++) {
+        sum += shape.r((i % (windowWidth * 16)) / 16.0f).y;
+    }
+    std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count() / evaluations;
+    printf("%-28s %8.2f ns/eval   (checksum %g)\n", "r", ns, sum);
+
+    sum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < evaluations; i++) {
+        sum += shape->arcLength((i % (windowWidth * 16)) / 16.0f);
+    }
+    stop = std::chrono::steady_clock::now();
+    ns = std::chrono::duration<double, std::nano>(stop - start).count() / evaluations;
+    printf("%-28s %8.2f ns/eval   (checksum %g)\n", "arcLength", ns, sum);
+
+    float total = shape->totalArcLength();
+    sum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < evaluations; i++) {
+        sum += shape->xAtArcLength(total * (i % 10007) / 10007.0f);
+    }
+    stop = std::chrono::steady_clock::now();
+    ns = std::chrono::duration<double, std::nano>(stop - start).count() / evaluations;
+    printf("%-28s %8.2f ns/eval   (checksum %g)\n", "xAtArcLength", ns, sum);
+
+    // Spline::r pins a version for every call
+    sum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < evaluations; i++) {
+        sum += spline.r((i % (windowWidth * 16)) / 16.0f).y;
+    }
+    stop = std::chrono::steady_clock::now();
+    ns = std::chrono::duration<double, std::nano>(stop - start).count() / evaluations;
+    printf("%-28s %8.2f ns/eval   (checksum %g)\n", "r, pinning every call", ns, sum);
+}
+
+int main(int argc, char * argv[]) {
+    int points = argc > 1 ? atoi(argv[1]) : 8;
+    int evaluations = argc > 2 ? atoi(argv[2]) : 10000000;
+    printf("%d control points, %d evaluations\n", points, evaluations);
+
+    bench("CardinalBasis(-0.1)", CardinalBasis(-0.1), points, evaluations);
+    bench("FixedCardinalBasis<-1>", FixedCardinalBasis<-1>(), points, evaluations);
+    bench("KochanekBartelsBasis<0,0,0>", KochanekBartelsBasis<0, 0, 0>(), points, evaluations);
+    bench("BSplineBasis", BSplineBasis(), points, evaluations);
+    benchQueries(points, evaluations / 10);
+    return 0;
+}
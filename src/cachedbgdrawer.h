@@ -0,0 +1,90 @@
+#ifndef CACHEDBGDRAWER_H
+#define CACHEDBGDRAWER_H
+
+/**
+ * BgDrawer on OpenGL. The layer only moves (by its transformationMatrix),
+ * so its curve is rendered once into a texture, and every frame only a
+ * textured quad is drawn. The texture is rendered again when the control
+ * points change.
+ */
+class CachedBgDrawer : public BgDrawer {
+    GlRenderBackend * backend; // the curve, drawn into the cache
+    ShaderProgram * texturedProgram; // the cached layer, with the MVP and textureUnit uniforms
+    unsigned int quadVao;
+    unsigned int quadVbo;
+    unsigned int fbo;
+    Texture texture;
+
+    // Draws the curve into the texture, in the local coordinates of the layer
+    void renderCache() {
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glViewport(0, 0, windowWidth, windowHeight);
+	glClearColor(0, 0, 0, 0);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	Camera layerCamera(vec2(windowWidth/2, windowHeight/2), windowWidth, windowHeight);
+	backend->setViewProjection(layerCamera.getMatrix());
+	backend->drawArrays(RenderBackend::LINE_STRIP, vec3(0.0f, 1.0f, 0.0f), &vertices[0], vertices.size() / 2);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, windowWidth, windowHeight);
+    }
+
+public:
+    CachedBgDrawer(BgSpline * ground, GlRenderBackend * backend, ShaderProgram * texturedProgram)
+    :BgDrawer(ground, backend), backend(backend), texturedProgram(texturedProgram)
+    {
+	// The texture covers the layer 1:1, no filtering needed
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, windowWidth, windowHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture.textureId, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	// Quad over the layer: x, y, u, v
+	float quad[] = {
+	    0,           0,            0, 0,
+	    windowWidth, 0,            1, 0,
+	    0,           windowHeight, 0, 1,
+	    windowWidth, windowHeight, 1, 1
+	};
+	glGenVertexArrays(1, &quadVao);
+	glBindVertexArray(quadVao);
+	glGenBuffers(1, &quadVbo);
+	glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);  // position
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), NULL);
+	glEnableVertexAttribArray(1);  // texture coordinate
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *) (2 * sizeof(float)));
+    }
+
+    /**
+     * @param viewProjection - The camera matrix, loaded into the backend's MVP on return
+     */
+    void draw(mat4 viewProjection) {
+	if (update()) renderCache();
+
+	texturedProgram->Use();
+	mat4 MVP = ground->transformationMatrix * viewProjection;
+	int location = glGetUniformLocation(texturedProgram->getId(), "MVP");
+	glUniformMatrix4fv(location, 1, GL_TRUE, &MVP.m[0][0]);
+	char samplerName[] = "textureUnit"; // SetUniform takes a char *
+	texture.SetUniform(texturedProgram->getId(), samplerName);
+
+	// The layer is transparent where the curve is not
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glBindVertexArray(quadVao);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	backend->countDraw(4);
+	glDisable(GL_BLEND);
+
+	backend->use();
+	backend->setViewProjection(viewProjection);
+    }
+};
+
+#endif // CACHEDBGDRAWER_H
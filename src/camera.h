@@ -24,6 +24,12 @@ public:
                 x_push,  y_push,   0, 1
         );
     }
+    // Screen pixels per world unit, the larger of the two axes
+    float getPixelsPerUnit() {
+        float x = windowWidth / width;
+        float y = windowHeight / height;
+        return x > y ? x : y;
+    }
     mat4 getInversMatrix() {
 	float x_push = center.x;
         float y_push = center.y;
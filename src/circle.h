@@ -4,6 +4,72 @@
 #include <vector>
 #include <math.h>
 
+/**
+ * Discrete levels of detail of the wheel: unit meshes (rim + 4 spokes) with
+ * fewer and fewer rim segments. A wheel uses the coarsest level whose rim
+ * is at most `maxPixelError` pixels away from the true circle. The meshes
+ * are in unit wheel coordinates, so they can be shared by batched or
+ * instanced drawing.
+ */
+struct WheelLod {
+    static const int levelCount = 6;
+
+    // Rim segments per level, multiples of 8 so the spokes sit on rim vertices
+    static int segments(int level) {
+        static const int table[levelCount] = { 8, 16, 32, 64, 128, 360 };
+        return table[level];
+    }
+
+    /**
+     * @param radiusPixels - Radius of the wheel on the screen
+     * @param maxPixelError - Allowed distance of a rim segment from the circle
+     */
+    static int selectLevel(float radiusPixels, float maxPixelError = 0.5f) {
+        for (int level = 0; level < levelCount - 1; level++) {
+            // Sagitta: the farthest point of an arc from its chord
+            float error = radiusPixels * (1 - cos(M_PI / segments(level)));
+            if (error <= maxPixelError) return level;
+        }
+        return levelCount - 1;
+    }
+
+    // Line strip of the unit wheel, built on first use
+    static const std::vector<vec4> & mesh(int level) {
+        static const std::vector<std::vector<vec4> > meshes = buildMeshes();
+        return meshes[level];
+    }
+
+private:
+    static std::vector<std::vector<vec4> > buildMeshes() {
+        std::vector<std::vector<vec4> > meshes;
+        for (int level = 0; level < levelCount; level++) meshes.push_back(buildMesh(segments(level)));
+        return meshes;
+    }
+
+    static std::vector<vec4> buildMesh(int n) {
+        std::vector<vec4> ret;
+        for (int i = 0; i <= n; i++) {
+            // edge will be the new point to add
+            vec4 edge(0, 0, 0, 1);
+            // convert i to radian
+            float theta_rad = i * 2 * M_PI / (float) n;
+
+            edge.x = cos(theta_rad);
+            edge.y = sin(theta_rad);
+            ret.push_back(edge);
+
+            // A spoke every 45 degrees
+            if (i % (n / 8) == 0) {
+                vec4 oppositeEdge = edge * (-1);
+                oppositeEdge.w = 1;
+                ret.push_back(oppositeEdge);
+                ret.push_back(edge);
+            }
+        }
+        return ret;
+    }
+};
+
 class Circle {
 
     float rad;
@@ -47,33 +113,40 @@ public:
     float alpha = 0;
     float getRad() { return rad; }
 
-    const std::vector<vec4> getDrawingPoints() {
-
-        std::vector<vec4> ret;
-        for (int i = 0; i < 361; i++) {
-            // edge will be the new point to add
-            vec4 edge(0, 0, 0, 1);
-            // convert i to radian
-            float theta_rad = i * 2 * M_PI / (float) 360;
-
-            edge.x = rad * cos(theta_rad);
-            edge.y = rad * sin(theta_rad);
-            ret.push_back(edge);
-            
-            if (i % 45 == 0) {
-                vec4 oppositeEdge = edge * (-1);
-                oppositeEdge.w = 1;
-                ret.push_back(oppositeEdge);
-                ret.push_back(edge);
-            }
-        }
-        for (int i = 0; i < ret.size(); i++) {
-            ret[i] = ret[i] * this->rotationMatrix();
-            ret[i] = ret[i] * this->centerSetterMatrix();
-            ret[i] = ret[i] * this->pushFromCenterMatrix();
+    /**
+     * @param level - Level of detail, see WheelLod
+     */
+    const std::vector<vec4> getDrawingPoints(int level = WheelLod::levelCount - 1) {
+        const std::vector<vec4> & unit = WheelLod::mesh(level);
+        mat4 model = ScaleMatrix(vec3(rad, rad, 0))
+            * this->rotationMatrix()
+            * this->centerSetterMatrix()
+            * this->pushFromCenterMatrix();
+
+        std::vector<vec4> ret(unit.size());
+        for (int i = 0; i < unit.size(); i++) {
+            vec4 point = unit[i];
+            ret[i] = point * model;
         }
         return ret;
     }
+
+    /**
+     * @param pixelsPerUnit - Screen pixels per world unit, see Camera
+     */
+    int lodLevel(float pixelsPerUnit, float maxPixelError = 0.5f) {
+        return WheelLod::selectLevel(rad * pixelsPerUnit, maxPixelError);
+    }
+};
+
+/**
+ * The constants of the ride, found by experimenting.
+ */
+struct RideParams {
+    float gravity = 10;          // scale of the gravitational force
+    float airResistance = 0.005; // drag per unit of velocity
+    float ride = 1.5;            // force of the rider, in the direction of travel
+    float angleFactor = 0.02;    // turn of the wheel per unit of distance
 };
 
 class CircleController {
@@ -81,81 +154,100 @@ class CircleController {
     Circle * circle;
     Spline * ground;
     bool rightGoing;
+    RideParams params;
+    float vel = 0; // distance along the ground per tick
+    int turnarounds = 0;
+    bool atSide = false; // stopped at a side in the last tick
 
 public:
-    CircleController(Circle * circle, Spline * ground, bool rightGoing = true)
-    :circle(circle), ground(ground), rightGoing(rightGoing)
+    CircleController(Circle * circle, Spline * ground, bool rightGoing = true, RideParams params = RideParams())
+    :circle(circle), ground(ground), rightGoing(rightGoing), params(params)
     {}
 
-    void tick() {
+    float getVelocity() { return vel; }
+    // Arrivals at a side, ahead or behind; resting against it counts once
+    int getTurnarounds() { return turnarounds; }
+
+    /**
+     * @return - Whether the circle has moved
+     */
+    bool tick() {
+        vec4 prevCenter = circle->center;
+        float prevAlpha = circle->alpha;
+        // The ground may be edited meanwhile, the whole step uses one version
+        Spline::Reader shape = ground->read();
         // Update circle data
         {
-            // The slope (derivative) (dx = vel)
-            float dy = ground->r(circle->center.x + 1).y - ground->r(circle->center.x).y;
+            // The slope (derivative) (dx = 1)
+            float dy = shape.r(circle->center.x + 1).y - shape.r(circle->center.x).y;
 
             // Update velocity
-            static float vel = 0; // difference in x coordinate
             {
 
                 // Effect of the gravitational
-                float f_grav_x; 
-                // The formula was calculated on a piece of paper
-                f_grav_x = -1 * (dy * 10) / (dy*dy + 1);
+                float f_grav; 
+                // Its component along the ground: g * sin(slope angle)
+                f_grav = -1 * (dy * params.gravity) / sqrt(dy*dy + 1);
 
                 // Effect of the air resistance
-                float f_airResistance_x;
+                float f_airResistance;
                 // Experimented constant * velocity
-                f_airResistance_x = -0.005 * vel;
+                f_airResistance = -params.airResistance * vel;
 
-                float f_ride = rightGoing ? 1.5 : -1.5;
+                float f_ride = rightGoing ? params.ride : -params.ride;
 
-                vel += f_grav_x;
-                vel += f_airResistance_x;
+                vel += f_grav;
+                vel += f_airResistance;
                 vel += f_ride;
             }
 
             // Update andle
             float dAlpha; 
             {
-                dAlpha = 0.02 * sqrt(dy*dy + vel*vel);
-                if (vel < 0) dAlpha *= -1;
+                // Rolls as far as it goes
+                dAlpha = params.angleFactor * vel;
             }
 
 
-            circle->center.x += vel;;
-            circle->alpha += dAlpha;
-            if (circle->alpha > 2 * M_PI) circle->alpha = 0;
+            // Move by vel along the ground (the ground has no transformation)
+            float s = shape->arcLength(circle->center.x);
+            circle->center.x = shape->xAtArcLength(s + vel);
 
             // Determine direction and manage turn arounds at the side
+            bool side = false;
             {
-                if (rightGoing) {
-                    // If the circle is beyond the right side
-                    // than turn around
-                    if (circle->center.x + circle->getRad() > windowWidth) {
-                        rightGoing = false;
-                        vel = 0;
-                        circle->center.x = windowWidth - circle->getRad();
-                    }
-                } else {
-                    // If the circle is beyond the left side
-                    // than turn around
-                    if (circle->center.x - circle->getRad() < 0) {
-                        rightGoing = true;
-                        vel = 0;
-                        circle->center.x = circle->getRad();
-                    }
+                // If the circle is beyond a side, ahead of it or rolled back
+                // down a hill behind it, than it stops and turns away from it
+                if (circle->center.x + circle->getRad() > windowWidth) {
+                    rightGoing = false;
+                    side = true;
+                    circle->center.x = windowWidth - circle->getRad();
+                }
+                if (circle->center.x - circle->getRad() < 0) {
+                    rightGoing = true;
+                    side = true;
+                    circle->center.x = circle->getRad();
                 }
-            } 
+                if (side) {
+                    vel = 0;
+                    // Only rolls as far as it got
+                    dAlpha = params.angleFactor * (shape->arcLength(circle->center.x) - s);
+                    if (!atSide) turnarounds++;
+                }
+                atSide = side;
+            }
+            circle->alpha += dAlpha;
+            if (circle->alpha > 2 * M_PI) circle->alpha = 0;
         }
         // Put circle to position (make it appear as if it would be on the line)
         {
             // Adjust y coordinate
             float x = circle->center.x;
-            circle->center.y = ground->r(x).y;
+            circle->center.y = shape.r(x).y;
 
             // Push circle perpendicular to the ground spline
             // This creates an illusion that the circle is ON the spline
-            vec2 diff = ground->r(x + 1) - ground->r(x);
+            vec2 diff = shape.r(x + 1) - shape.r(x);
             vec2 normal;
             // Swap coordinates and -1 (turn 90grad)
             normal.x = diff.y * (-1); normal.y = diff.x;
@@ -168,35 +260,30 @@ public:
 
             circle->pushFromCenter = normal;
         }
+        return circle->center.x != prevCenter.x || circle->center.y != prevCenter.y
+            || circle->alpha != prevAlpha;
     }
 };
 
 class CircleDrawer {
 
-    Circle* circle;
-    unsigned int vao;
-    unsigned int vbo;
+    RenderBackend * backend;
 
 public:
 
-    CircleDrawer(Circle* circle)
-    :circle(circle)
-    {
-	glGenVertexArrays(1, &vao);
-	glGenBuffers(1, &vbo);
-    }
+    CircleDrawer(RenderBackend * backend)
+    :backend(backend)
+    {}
 
-    void draw() {
-        // set color
-        int location = glGetUniformLocation(gpuProgram.getId(), "color");
-        glUniform3f(location, 1.0f, 0.5f, 0.0f); 
-        // vao, vbo
-	glBindVertexArray(vao);		
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        // Get drawing vertices from circle and copy it to the gpu
-        std::vector<vec4> vVertices = circle->getDrawingPoints();
-        // This array will be copied to the gpu
-        float fVertices[vVertices.size() * 2];
+    /**
+     * Builds the line strip of the circle, does not need OpenGL.
+     * The level of detail follows the size of the circle on the screen.
+     * @param pixelsPerUnit - Screen pixels per world unit, see Camera
+     */
+    static void generate(Circle * circle, std::vector<float> & fVertices,
+                         float pixelsPerUnit = 1, float maxPixelError = 0.5f) {
+        std::vector<vec4> vVertices = circle->getDrawingPoints(circle->lodLevel(pixelsPerUnit, maxPixelError));
+        fVertices.resize(vVertices.size() * 2);
 
         // copy values to fVertices
         int doubleStep = 0;
@@ -205,17 +292,14 @@ public:
             fVertices[doubleStep + 1] = vVertices[i].y;
             doubleStep += 2;
         }
+    }
 
-	glBufferData(GL_ARRAY_BUFFER, 	// Copy to GPU target
-		sizeof(fVertices),  // # bytes
-		fVertices,	      	// address
-		GL_DYNAMIC_DRAW);	
-
-	glEnableVertexAttribArray(0);  // AttribArray 0
-	glVertexAttribPointer(0,       // vbo -> AttribArray 0
-		2, GL_FLOAT, GL_FALSE, // two floats/attrib, not fixed-point
-		0, NULL); 		     // stride, offset: tightly packed
-	glDrawArrays(GL_LINE_STRIP, 0 /*startIdx*/, vVertices.size() /*# Elements*/);
+    /**
+     * @param fVertices - Made by generate()
+     */
+    void draw(const std::vector<float> & fVertices) {
+        if (fVertices.empty()) return;
+        backend->drawArrays(RenderBackend::LINE_STRIP, vec3(1.0f, 0.5f, 0.0f), &fVertices[0], fVertices.size() / 2);
     }
 };
 
@@ -0,0 +1,374 @@
+#ifndef CPURASTERIZER_H
+#define CPURASTERIZER_H
+
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+/**
+ * RenderBackend without OpenGL: rasterizes into an RGBA8 framebuffer.
+ *
+ * clear() and drawArrays only record: the vertices are transformed into
+ * line segments and polygon edges. flush() splits the image into bands of
+ * rows, and the bands are rasterized in parallel. A band clears its rows,
+ * then draws the shapes reaching into it in submission order, scan
+ * converting the polygons over its own rows only, so all of the per-pixel
+ * work is spread over the threads. Spans are filled 4 pixels at a time
+ * with SSE2.
+ *
+ * A triangle strip is filled as the polygon outlined by its even and odd
+ * vertices (even-odd rule). That is exact for ribbons like the ground,
+ * but not for strips folding over themselves.
+ *
+ * Like OpenGL, row 0 is the bottom of the image.
+ */
+class CpuRasterizer : public RenderBackend {
+
+    // Rows per band, a band is the unit of work of a thread
+    static const int bandHeight = 16;
+
+    // A recorded line segment or polygon
+    struct Shape {
+        bool polygon;
+        float x[2], y[2];   // pixel coordinates of a line
+        int polygonIndex;
+        unsigned int color;
+        int minX, minY, maxX, maxY;
+    };
+
+    struct Edge {
+        float yMin, yMax, x, dxdy; // x at yMin
+        static bool byYMin(const Edge * a, const Edge * b) { return a->yMin < b->yMin; }
+    };
+
+    struct Polygon {
+        std::vector<Edge> edges;    // pixel coordinates, in no order
+    };
+
+    // Per thread buffers of the scan conversion, reused from band to band
+    struct Scratch {
+        std::vector<const Edge *> edges;
+        std::vector<const Edge *> active;
+        std::vector<float> crossings;
+    };
+
+    int width, height;
+    std::vector<unsigned int> pixels; // R, G, B, A bytes in memory
+    mat4 viewProjection;
+    std::vector<Shape> shapes;
+    std::vector<Polygon> polygons;
+    bool clearPending = false;
+    unsigned int clearColor;
+
+    int bands;
+
+    // Worker threads, the caller of flush() works too
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable condition;
+    long generation = 0;  // one per flush
+    int pending = 0;      // workers still busy with the current flush
+    bool quit = false;
+    std::atomic<int> nextBand;
+
+    static unsigned int pack(vec3 color, float alpha = 1) {
+        unsigned int r = (unsigned int) (fminf(fmaxf(color.x, 0), 1) * 255 + 0.5f);
+        unsigned int g = (unsigned int) (fminf(fmaxf(color.y, 0), 1) * 255 + 0.5f);
+        unsigned int b = (unsigned int) (fminf(fmaxf(color.z, 0), 1) * 255 + 0.5f);
+        unsigned int a = (unsigned int) (fminf(fmaxf(alpha, 0), 1) * 255 + 0.5f);
+        unsigned char bytes[4] = { (unsigned char) r, (unsigned char) g, (unsigned char) b, (unsigned char) a };
+        unsigned int packed;
+        memcpy(&packed, bytes, 4);
+        return packed;
+    }
+
+    static void fillSpan(unsigned int * p, int count, unsigned int color) {
+#if defined(__SSE2__) || defined(_M_X64)
+        __m128i c = _mm_set1_epi32((int) color);
+        while (count >= 4) {
+            _mm_storeu_si128((__m128i *) p, c);
+            p += 4;
+            count -= 4;
+        }
+#endif
+        while (count-- > 0) *p++ = color;
+    }
+
+    vec2 toPixels(float x, float y) {
+        vec4 ndc = vec4(x, y, 0, 1) * viewProjection;
+        return vec2((ndc.x / ndc.w + 1) / 2 * width, (ndc.y / ndc.w + 1) / 2 * height);
+    }
+
+    void record(Shape & shape, const vec2 * points, int count) {
+        float minX = points[0].x, maxX = minX, minY = points[0].y, maxY = minY;
+        for (int i = 1; i < count; i++) {
+            minX = fminf(minX, points[i].x); maxX = fmaxf(maxX, points[i].x);
+            minY = fminf(minY, points[i].y); maxY = fmaxf(maxY, points[i].y);
+        }
+        shape.minX = (int) fmaxf(floorf(minX), 0);
+        shape.minY = (int) fmaxf(floorf(minY), 0);
+        shape.maxX = (int) fminf(floorf(maxX), width - 1);
+        shape.maxY = (int) fminf(floorf(maxY), height - 1);
+        if (shape.minX > shape.maxX || shape.minY > shape.maxY) return; // off screen
+        shapes.push_back(shape);
+    }
+
+    // Even-odd scan conversion with an active edge table, pixel centers inside, rows y0..y1 - 1 only
+    void rasterizePolygon(const Shape & shape, int y0, int y1, Scratch & scratch) {
+        int rowFrom = shape.minY > y0 ? shape.minY : y0;
+        int rowTo = shape.maxY < y1 - 1 ? shape.maxY : y1 - 1;
+        float firstCenter = rowFrom + 0.5f, lastCenter = rowTo + 0.5f;
+
+        // Only the edges crossing a row center of the band
+        const std::vector<Edge> & edges = polygons[shape.polygonIndex].edges;
+        scratch.edges.clear();
+        for (int i = 0; i < edges.size(); i++) {
+            if (edges[i].yMin <= lastCenter && edges[i].yMax > firstCenter) scratch.edges.push_back(&edges[i]);
+        }
+        std::sort(scratch.edges.begin(), scratch.edges.end(), Edge::byYMin);
+
+        std::vector<const Edge *> & active = scratch.active;
+        std::vector<float> & crossings = scratch.crossings;
+        active.clear();
+        int next = 0;
+        for (int y = rowFrom; y <= rowTo; y++) {
+            float yc = y + 0.5f;
+            while (next < scratch.edges.size() && scratch.edges[next]->yMin <= yc) active.push_back(scratch.edges[next++]);
+
+            crossings.clear();
+            int kept = 0;
+            for (int i = 0; i < active.size(); i++) {
+                const Edge * edge = active[i];
+                if (edge->yMax <= yc) continue; // ended
+                active[kept++] = edge;
+                crossings.push_back(edge->x + (yc - edge->yMin) * edge->dxdy);
+            }
+            active.resize(kept);
+            std::sort(crossings.begin(), crossings.end());
+
+            for (int i = 0; i + 1 < crossings.size(); i += 2) {
+                int from = (int) ceilf(crossings[i] - 0.5f);
+                int to = (int) ceilf(crossings[i + 1] - 0.5f);
+                if (from < 0) from = 0;
+                if (to > width) to = width;
+                if (from < to) fillSpan(&pixels[y * width + from], to - from, shape.color);
+            }
+        }
+    }
+
+    // One pixel per step along the major axis
+    void rasterizeLine(const Shape & l, int x0, int y0, int x1, int y1) {
+        float ax = l.x[0], ay = l.y[0], bx = l.x[1], by = l.y[1];
+        bool xMajor = fabsf(bx - ax) >= fabsf(by - ay);
+        if (!xMajor) { // walk along y instead, with the roles swapped
+            float tmp;
+            tmp = ax; ax = ay; ay = tmp;
+            tmp = bx; bx = by; by = tmp;
+        }
+        if (ax > bx) {
+            float tmp;
+            tmp = ax; ax = bx; bx = tmp;
+            tmp = ay; ay = by; by = tmp;
+        }
+        float slope = bx > ax ? (by - ay) / (bx - ax) : 0;
+        int majorFrom = (int) floorf(ax), majorTo = (int) floorf(bx);
+        int majorMin = xMajor ? x0 : y0, majorMax = xMajor ? x1 : y1;
+        int minorMin = xMajor ? y0 : x0, minorMax = xMajor ? y1 : x1;
+        if (majorFrom < majorMin) majorFrom = majorMin;
+        if (majorTo > majorMax - 1) majorTo = majorMax - 1;
+        if (slope != 0) { // only where the line is inside the minor range, with a pixel to spare
+            float from = ax + (minorMin - ay) / slope, to = ax + (minorMax - ay) / slope;
+            if (from > to) { float tmp = from; from = to; to = tmp; }
+            if (majorFrom < (int) floorf(from) - 1) majorFrom = (int) floorf(from) - 1;
+            if (majorTo > (int) floorf(to) + 1) majorTo = (int) floorf(to) + 1;
+        }
+        for (int major = majorFrom; major <= majorTo; major++) {
+            float center = major + 0.5f;
+            if (center < ax) center = ax;
+            if (center > bx) center = bx;
+            int minor = (int) floorf(ay + (center - ax) * slope);
+            if (minor < minorMin || minor >= minorMax) continue;
+            if (xMajor) pixels[minor * width + major] = l.color;
+            else pixels[major * width + minor] = l.color;
+        }
+    }
+
+    void renderBand(int band, Scratch & scratch) {
+        int y0 = band * bandHeight;
+        int y1 = y0 + bandHeight < height ? y0 + bandHeight : height;
+        if (clearPending) fillSpan(&pixels[y0 * width], (y1 - y0) * width, clearColor);
+        for (int i = 0; i < shapes.size(); i++) {
+            const Shape & shape = shapes[i];
+            if (shape.maxY < y0 || shape.minY >= y1) continue;
+            if (shape.polygon) rasterizePolygon(shape, y0, y1, scratch);
+            else rasterizeLine(shape, 0, y0, width, y1);
+        }
+    }
+
+    void runBands() {
+        Scratch scratch;
+        while (true) {
+            int band = nextBand.fetch_add(1);
+            if (band >= bands) return;
+            renderBand(band, scratch);
+        }
+    }
+
+    void work() {
+        long done = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [&] { return quit || generation != done; });
+                if (quit) return;
+                done = generation;
+            }
+            runBands();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pending--;
+                condition.notify_all();
+            }
+        }
+    }
+
+public:
+
+    /**
+     * @param threads - Rasterizer threads, including the one calling flush()
+     */
+    CpuRasterizer(int width = windowWidth, int height = windowHeight, int threads = 1)
+    :width(width), height(height), pixels(width * height), nextBand(0)
+    {
+        viewProjection = ScaleMatrix(vec3(1, 1, 1));
+        bands = (height + bandHeight - 1) / bandHeight;
+        for (int i = 1; i < threads; i++) workers.push_back(std::thread(&CpuRasterizer::work, this));
+    }
+
+    int getWidth() { return width; }
+    int getHeight() { return height; }
+    const unsigned int * getPixels() { return &pixels[0]; }
+
+    // Drops what was drawn since the last flush(), the image is cleared by the next flush()
+    void clear(vec3 color, float alpha = 1) {
+        shapes.clear();
+        polygons.clear();
+        clearPending = true;
+        clearColor = pack(color, alpha);
+    }
+
+    void setViewProjection(mat4 viewProjection) {
+        this->viewProjection = viewProjection;
+    }
+
+    void drawArrays(Primitive type, vec3 color, const float * vertices, int vertexCount) {
+        unsigned int packed = pack(color);
+        std::vector<vec2> points(vertexCount);
+        for (int i = 0; i < vertexCount; i++) points[i] = toPixels(vertices[2 * i], vertices[2 * i + 1]);
+
+        Shape shape;
+        shape.color = packed;
+        if (type == TRIANGLE_STRIP) {
+            if (vertexCount < 3) return;
+            // Outline: the even vertices forward, then the odd ones backward
+            std::vector<vec2> outline;
+            for (int i = 0; i < vertexCount; i += 2) outline.push_back(points[i]);
+            for (int i = (vertexCount - 1) | 1; i >= 1; i -= 2) {
+                if (i < vertexCount) outline.push_back(points[i]);
+            }
+            Polygon polygon;
+            int n = outline.size();
+            for (int i = 0; i < n; i++) {
+                vec2 a = outline[i], b = outline[(i + 1) % n];
+                if (a.y == b.y) continue; // horizontal edges never cross a row center
+                if (a.y > b.y) { vec2 tmp = a; a = b; b = tmp; }
+                Edge edge = { a.y, b.y, a.x, (b.x - a.x) / (b.y - a.y) };
+                polygon.edges.push_back(edge);
+            }
+            shape.polygon = true;
+            shape.polygonIndex = polygons.size();
+            polygons.push_back(polygon);
+            record(shape, &points[0], vertexCount);
+        } else {
+            shape.polygon = false;
+            // A strip joins every vertex to the next, LINES only the pairs
+            int step = type == LINES ? 2 : 1;
+            for (int i = 1; i < vertexCount; i += step) {
+                shape.x[0] = points[i - 1].x; shape.y[0] = points[i - 1].y;
+                shape.x[1] = points[i].x;     shape.y[1] = points[i].y;
+                record(shape, &points[i - 1], 2);
+            }
+        }
+    }
+
+    /**
+     * Clears if clear() was called and rasterizes everything drawn since
+     * the last flush() or clear().
+     */
+    void flush() {
+        nextBand = 0;
+        if (!workers.empty()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending = workers.size();
+            generation++;
+            condition.notify_all();
+        }
+        runBands();
+        if (!workers.empty()) {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return pending == 0; });
+        }
+        shapes.clear();
+        polygons.clear();
+        clearPending = false;
+    }
+
+    /**
+     * Uncompressed 32 bit TGA, bottom row first like the framebuffer.
+     * @return - false if the file could not be written
+     */
+    bool writeTga(const char * path) {
+        FILE * file = fopen(path, "wb");
+        if (!file) return false;
+        unsigned char header[18] = { 0 };
+        header[2] = 2;  // uncompressed true color
+        header[12] = width & 0xff; header[13] = width >> 8;
+        header[14] = height & 0xff; header[15] = height >> 8;
+        header[16] = 32; // bits per pixel
+        header[17] = 8;  // alpha bits, origin bottom left
+        fwrite(header, 1, sizeof(header), file);
+
+        std::vector<unsigned char> row(width * 4);
+        for (int y = 0; y < height; y++) {
+            const unsigned char * rgba = (const unsigned char *) &pixels[y * width];
+            for (int x = 0; x < width; x++) { // TGA stores BGRA
+                row[4 * x] = rgba[4 * x + 2];
+                row[4 * x + 1] = rgba[4 * x + 1];
+                row[4 * x + 2] = rgba[4 * x];
+                row[4 * x + 3] = rgba[4 * x + 3];
+            }
+            fwrite(&row[0], 1, row.size(), file);
+        }
+        return fclose(file) == 0;
+    }
+
+    virtual ~CpuRasterizer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+            condition.notify_all();
+        }
+        for (int i = 0; i < workers.size(); i++) workers[i].join();
+    }
+};
+
+#endif // CPURASTERIZER_H
@@ -0,0 +1,117 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <stdio.h>
+#include <math.h>
+#include <ctime>
+#include <chrono>
+#include <thread>
+
+/**
+ * Paces the idle callback: instead of polling the clock it sleeps until
+ * the next frame is due, and it only asks for a redraw if something
+ * changed since the last one.
+ *
+ *     framePacer.waitForNextFrame();
+ *     if (sceneChanged) framePacer.invalidate();
+ *     if (framePacer.needsRedraw()) glutPostRedisplay();
+ */
+class FramePacer {
+
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::duration period;
+    Clock::time_point deadline;
+    bool dirty = true;
+
+    // Statistics since the last resetStatistics()
+    long frames;
+    long redraws;
+    double jitterSum; // ms
+    double jitterMax; // ms
+    Clock::time_point wallStart;
+    std::clock_t cpuStart;
+
+public:
+
+    /**
+     * @param targetRate - Frames per second
+     */
+    FramePacer(float targetRate = 20)
+    {
+        setTargetRate(targetRate);
+        deadline = Clock::now() + period;
+        resetStatistics();
+    }
+
+    void setTargetRate(float targetRate) {
+        period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetRate));
+    }
+
+    float getTargetRate() {
+        return 1.0 / std::chrono::duration<double>(period).count();
+    }
+
+    /**
+     * Sleeps until the next frame is due.
+     */
+    void waitForNextFrame() {
+        std::this_thread::sleep_until(deadline);
+        Clock::time_point now = Clock::now();
+
+        double jitter = fabs(std::chrono::duration<double, std::milli>(now - deadline).count());
+        jitterSum += jitter;
+        if (jitter > jitterMax) jitterMax = jitter;
+        frames++;
+
+        deadline += period;
+        // Fell behind by more than a frame: do not try to catch up with a burst of frames
+        if (deadline < now) deadline = now + period;
+    }
+
+    // Something visible changed, the next frame has to be drawn
+    void invalidate() { dirty = true; }
+
+    /**
+     * @return - Whether the frame has to be redrawn, clears the request
+     */
+    bool needsRedraw() {
+        bool redraw = dirty;
+        dirty = false;
+        if (redraw) redraws++;
+        return redraw;
+    }
+
+    long getFrames() { return frames; }
+    long getRedraws() { return redraws; }
+
+    // Mean distance between the deadlines and the actual wake ups, in ms
+    float getMeanJitter() { return frames ? jitterSum / frames : 0; }
+    float getMaxJitter() { return jitterMax; }
+
+    /**
+     * Process cpu time over wall time since resetStatistics(), 1 is a fully
+     * used core. (On Windows std::clock measures wall time, so there it is ~1.)
+     */
+    float getCpuUtilisation() {
+        double wall = std::chrono::duration<double>(Clock::now() - wallStart).count();
+        double cpu = (double) (std::clock() - cpuStart) / CLOCKS_PER_SEC;
+        return wall > 0 ? cpu / wall : 0;
+    }
+
+    void resetStatistics() {
+        frames = 0;
+        redraws = 0;
+        jitterSum = 0;
+        jitterMax = 0;
+        wallStart = Clock::now();
+        cpuStart = std::clock();
+    }
+
+    void printStatistics() {
+        printf("%.1f fps target, %ld frames, %ld redraws, jitter mean %.3f ms max %.3f ms, cpu %.1f%%\n",
+                getTargetRate(), frames, redraws, getMeanJitter(), getMaxJitter(), 100 * getCpuUtilisation());
+    }
+};
+
+#endif // FRAMEPACER_H
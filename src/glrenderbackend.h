@@ -0,0 +1,64 @@
+#ifndef GLRENDERBACKEND_H
+#define GLRENDERBACKEND_H
+
+#include <string.h>
+
+/**
+ * Draws with a program that has the MVP and color uniforms, the vertices go
+ * through a StreamBuffer.
+ */
+class GlRenderBackend : public RenderBackend {
+
+    ShaderProgram * program;
+    StreamBuffer * stream;
+    unsigned int vao;
+
+public:
+    // Totals since the start, the Profiler takes their differences
+    unsigned long drawCalls = 0;
+    unsigned long vertices = 0;
+
+    GlRenderBackend(ShaderProgram * program, StreamBuffer * stream)
+    :program(program), stream(stream)
+    {
+	glGenVertexArrays(1, &vao);
+    }
+
+    // Makes the program current again after someone else used another one
+    void use() {
+	program->Use();
+    }
+
+    void setViewProjection(mat4 viewProjection) {
+	int location = glGetUniformLocation(program->getId(), "MVP");	// Get the GPU location of uniform variable MVP
+	glUniformMatrix4fv(location, 1, GL_TRUE, &viewProjection.m[0][0]);	// Load a 4x4 row-major float matrix to the specified location
+    }
+
+    // For the draws that bypass drawArrays
+    void countDraw(int vertexCount) {
+	drawCalls++;
+	vertices += vertexCount;
+    }
+
+    void drawArrays(Primitive primitive, vec3 color, const float * vertices, int vertexCount) {
+	if (vertexCount == 0) return;
+	countDraw(vertexCount);
+	int location = glGetUniformLocation(program->getId(), "color");
+	glUniform3f(location, color.x, color.y, color.z);
+	glBindVertexArray(vao);		// make it active
+
+	// Copy the vertices into the streaming buffer (binds it too)
+	size_t bytes = vertexCount * 2 * sizeof(float);
+	memcpy(stream->begin(bytes), vertices, bytes);
+	size_t offset = stream->end();
+
+	glEnableVertexAttribArray(0);  // AttribArray 0
+	glVertexAttribPointer(0,       // vbo -> AttribArray 0
+		2, GL_FLOAT, GL_FALSE, // two floats/attrib, not fixed-point
+		0, (void *) offset);   // stride, offset: tightly packed, region in the stream buffer
+	GLenum mode = primitive == LINE_STRIP ? GL_LINE_STRIP : primitive == LINES ? GL_LINES : GL_TRIANGLE_STRIP;
+	glDrawArrays(mode, 0 /*startIdx*/, vertexCount /*# Elements*/);
+    }
+};
+
+#endif // GLRENDERBACKEND_H
@@ -0,0 +1,270 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <map>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE  4
+
+// Messages below this level are compiled out (their arguments are still type checked),
+// e.g. -DLOG_LEVEL=LOG_LEVEL_DEBUG
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+/**
+ * One printf argument, kept until the logging thread formats the message.
+ * Strings are kept by pointer, so they have to live forever (literals).
+ */
+struct LogArg {
+    enum Type { INT, LONG, LONG_LONG, DOUBLE, STRING, POINTER };
+    Type type;
+    union {
+        long long i;
+        double d;
+        const char * s;
+        const void * p;
+    };
+
+    LogArg() {}
+    LogArg(int v) :type(INT) { i = v; }
+    LogArg(unsigned int v) :type(INT) { i = v; }
+    LogArg(long v) :type(LONG) { i = v; }
+    LogArg(unsigned long v) :type(LONG) { i = v; }
+    LogArg(long long v) :type(LONG_LONG) { i = v; }
+    LogArg(unsigned long long v) :type(LONG_LONG) { i = v; }
+    LogArg(double v) :type(DOUBLE) { d = v; }
+    LogArg(const char * v) :type(STRING) { s = v; }
+    LogArg(const void * v) :type(POINTER) { p = v; }
+};
+
+/**
+ * Leveled logging. The calling thread only copies the format pointer and
+ * the arguments into a lock-free queue, the messages are formatted and
+ * printed to stderr by a background thread. If the queue is full the message is
+ * dropped and counted.
+ *
+ * Every call site (format string) may print `burst` messages per second,
+ * the rest is counted and reported as one line.
+ *
+ * Use it through the LOG_DEBUG/LOG_INFO/LOG_WARN/LOG_ERROR macros.
+ */
+class Logger {
+
+    static const int capacity = 4096; // power of two
+    static const int maxArgs = 4;
+    static const int burst = 5;
+
+    struct Record {
+        std::atomic<unsigned long> sequence;
+        int level;
+        const char * format;
+        int argCount;
+        LogArg args[maxArgs];
+    };
+
+    // Bounded multi-producer queue (D. Vyukov), one consumer
+    Record records[capacity];
+    std::atomic<unsigned long> enqueuePos;
+    unsigned long dequeuePos = 0;
+    std::atomic<unsigned long> dropped;
+
+    struct RateState {
+        std::chrono::steady_clock::time_point windowStart;
+        int printed;
+        int suppressed;
+    };
+    std::map<const char *, RateState> rates;
+
+    std::atomic<bool> running;
+    std::thread worker;
+
+    static const char * levelName(int level) {
+        switch (level) {
+        case LOG_LEVEL_DEBUG: return "DEBUG";
+        case LOG_LEVEL_INFO:  return "INFO";
+        case LOG_LEVEL_WARN:  return "WARN";
+        default:              return "ERROR";
+        }
+    }
+
+    // printf with the stored arguments, one conversion at a time
+    static std::string format(const char * format, const LogArg * args, int argCount) {
+        std::string out;
+        char spec[32], buffer[256];
+        int arg = 0;
+        const char * c = format;
+        while (*c) {
+            if (*c != '%') { out += *c++; continue; }
+            if (c[1] == '%') { out += '%'; c += 2; continue; }
+            // Copy the conversion specification, e.g. "%3.2f"
+            int len = 0;
+            spec[len++] = *c++;
+            while (*c && !strchr("diouxXeEfFgGaAcspn", *c) && len < (int) sizeof(spec) - 2) spec[len++] = *c++;
+            if (!*c) break;
+            spec[len++] = *c++;
+            spec[len] = 0;
+            if (arg >= argCount) { out += spec; continue; }
+
+            const LogArg & a = args[arg++];
+            switch (a.type) {
+            case LogArg::INT:       snprintf(buffer, sizeof(buffer), spec, (int) a.i); break;
+            case LogArg::LONG:      snprintf(buffer, sizeof(buffer), spec, (long) a.i); break;
+            case LogArg::LONG_LONG: snprintf(buffer, sizeof(buffer), spec, a.i); break;
+            case LogArg::DOUBLE:    snprintf(buffer, sizeof(buffer), spec, a.d); break;
+            case LogArg::STRING:    snprintf(buffer, sizeof(buffer), spec, a.s ? a.s : "(null)"); break;
+            case LogArg::POINTER:   snprintf(buffer, sizeof(buffer), spec, a.p); break;
+            }
+            out += buffer;
+        }
+        return out;
+    }
+
+    void print(const Record & record) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::map<const char *, RateState>::iterator it = rates.find(record.format);
+        if (it == rates.end()) {
+            RateState state = { now, 0, 0 };
+            it = rates.insert(std::make_pair(record.format, state)).first;
+        }
+        RateState & rate = it->second;
+        if (now - rate.windowStart > std::chrono::seconds(1)) {
+            reportSuppressed(record.format, rate);
+            rate.windowStart = now;
+            rate.printed = 0;
+        }
+        if (rate.printed >= burst) {
+            rate.suppressed++;
+            return;
+        }
+        rate.printed++;
+
+        std::string message = format(record.format, record.args, record.argCount);
+        fprintf(stderr, "[%s] %s\n", levelName(record.level), message.c_str());
+    }
+
+    void reportSuppressed(const char * format, RateState & rate) {
+        if (rate.suppressed > 0) {
+            fprintf(stderr, "[INFO] \"%s\" repeated %d more times\n", format, rate.suppressed);
+            rate.suppressed = 0;
+        }
+    }
+
+    // Prints everything in the queue, returns whether there was anything
+    bool drain() {
+        bool any = false;
+        while (true) {
+            Record & record = records[dequeuePos & (capacity - 1)];
+            if (record.sequence.load(std::memory_order_acquire) != dequeuePos + 1) break;
+            print(record);
+            record.sequence.store(dequeuePos + capacity, std::memory_order_release);
+            dequeuePos++;
+            any = true;
+        }
+        unsigned long lost = dropped.exchange(0);
+        if (lost) fprintf(stderr, "[WARN] log queue full, %lu messages dropped\n", lost);
+        if (any) fflush(stderr);
+        return any;
+    }
+
+    void run() {
+        while (running.load()) {
+            if (!drain()) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        drain();
+        std::map<const char *, RateState>::iterator it;
+        for (it = rates.begin(); it != rates.end(); ++it) reportSuppressed(it->first, it->second);
+        fflush(stderr);
+    }
+
+public:
+
+    Logger()
+    :enqueuePos(0), dropped(0), running(true)
+    {
+        for (unsigned long i = 0; i < capacity; i++) records[i].sequence.store(i);
+        worker = std::thread(&Logger::run, this);
+    }
+
+    /**
+     * @param format - printf format, has to live forever (a literal)
+     */
+    void push(int level, const char * format, const LogArg * args, int argCount) {
+        unsigned long pos = enqueuePos.load(std::memory_order_relaxed);
+        Record * record;
+        while (true) {
+            record = &records[pos & (capacity - 1)];
+            unsigned long sequence = record->sequence.load(std::memory_order_acquire);
+            long diff = (long) sequence - (long) pos;
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        record->level = level;
+        record->format = format;
+        record->argCount = argCount < maxArgs ? argCount : maxArgs;
+        for (int i = 0; i < record->argCount; i++) record->args[i] = args[i];
+        record->sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    void log(int level, const char * format) {
+        push(level, format, NULL, 0);
+    }
+
+    template <class... Args>
+    void log(int level, const char * format, Args... args) {
+        LogArg packed[] = { LogArg(args)... };
+        push(level, format, packed, sizeof...(args));
+    }
+
+    virtual ~Logger() {
+        running.store(false);
+        worker.join();
+    }
+};
+
+// The logger of the process, started on first use
+inline Logger & logger() {
+    static Logger instance;
+    return instance;
+}
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) logger().log(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do { if (0) logger().log(LOG_LEVEL_DEBUG, __VA_ARGS__); } while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) logger().log(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do { if (0) logger().log(LOG_LEVEL_INFO, __VA_ARGS__); } while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(...) logger().log(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) do { if (0) logger().log(LOG_LEVEL_WARN, __VA_ARGS__); } while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) logger().log(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do { if (0) logger().log(LOG_LEVEL_ERROR, __VA_ARGS__); } while (0)
+#endif
+
+#endif // LOG_H
@@ -0,0 +1,122 @@
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include <vector>
+#include <stdio.h>
+#include <ctype.h>
+
+/**
+ * Minimal stroke font: every glyph is a few line segments on a 3 x 5 grid,
+ * so text is drawn as GL_LINES without textures. Knows A-Z (lower case is
+ * drawn as upper case), 0-9 and . / - %.
+ */
+struct StrokeFont {
+
+    /**
+     * Segments of the glyph, "x0y0x1y1" digit groups separated by spaces,
+     * y grows upwards. Unknown characters are blank.
+     */
+    static const char * glyph(char c) {
+        static const char * digits[10] = {
+            "0020 2024 2404 0400 0024", "1014 1403 0020", "0424 2422 2202 0200 0020",
+            "0424 2420 2000 1222", "0402 0222 2420", "2404 0402 0222 2220 2000",
+            "2404 0400 0020 2022 2202", "0424 2420", "0020 2024 2404 0400 0222",
+            "2202 0204 0424 2420 2000"
+        };
+        static const char * letters[26] = {
+            "0004 0424 2420 0222", "0004 0414 1412 0222 2220 2000", "2404 0400 0020",
+            "0004 0414 1423 2321 2110 1000", "2404 0400 0020 0212", "2404 0400 0212",
+            "2404 0400 0020 2022 2212", "0004 2420 0222", "0424 1410 0020",
+            "0424 2420 2000 0001", "0004 0224 0220", "0400 0020",
+            "0004 0412 1224 2420", "0004 0420 2024", "0020 2024 2404 0400",
+            "0004 0424 2422 2202", "0020 2024 2404 0400 1120", "0004 0424 2422 2202 0220",
+            "2404 0402 0222 2220 2000", "0424 1410", "0400 0020 2024",
+            "0410 1024", "0400 0011 1120 2024", "0024 0420",
+            "0412 1224 1210", "0424 2400 0020"
+        };
+        if (c >= '0' && c <= '9') return digits[c - '0'];
+        c = toupper(c);
+        if (c >= 'A' && c <= 'Z') return letters[c - 'A'];
+        switch (c) {
+        case '.': return "1011";
+        case '/': return "0024";
+        case '-': return "0222";
+        case '%': return "0024 0304 2021";
+        }
+        return "";
+    }
+
+    /**
+     * Appends the segments of the text to lines as GL_LINES vertices.
+     * @param x, y - Bottom left corner of the first glyph, in pixels
+     * @param scale - Pixels per grid unit, a glyph is 2 * scale wide and 4 * scale high
+     */
+    static void addText(std::vector<float> & lines, const char * text, float x, float y, float scale) {
+        for (const char * c = text; *c; c++) {
+            for (const char * s = glyph(*c); s[0] && s[1] && s[2] && s[3]; s += s[4] ? 5 : 4) {
+                lines.push_back(x + (s[0] - '0') * scale);
+                lines.push_back(y + (s[1] - '0') * scale);
+                lines.push_back(x + (s[2] - '0') * scale);
+                lines.push_back(y + (s[3] - '0') * scale);
+            }
+            x += 3 * scale; // glyph and gap
+        }
+    }
+};
+
+/**
+ * Draws the statistics of the Profiler over the scene: a table of the
+ * passes and a graph of the frame interval (white) and the gpu time
+ * (yellow) of the last frames, 1 pixel per ms. All the text is one draw.
+ */
+class PerfOverlay {
+
+    RenderBackend * backend;
+    std::vector<float> text;
+    std::vector<float> graph;
+
+public:
+    bool visible = false;
+
+    PerfOverlay(RenderBackend * backend)
+    :backend(backend)
+    {}
+
+    void draw(const Profiler & profiler) {
+        // Pixel coordinates, (0, 0) is the bottom left corner of the window
+        Camera screen(vec2(windowWidth / 2, windowHeight / 2), windowWidth, windowHeight);
+        backend->setViewProjection(screen.getMatrix());
+
+        const float scale = 2, lineHeight = 14, left = 8;
+        float y = windowHeight - lineHeight;
+        char line[96];
+        text.clear();
+        snprintf(line, sizeof(line), "FRAME %6.2f MS  CPU %6.3f MS", profiler.getFrameIntervalMs(), profiler.getFrameCpuMs());
+        StrokeFont::addText(text, line, left, y, scale);
+        y -= lineHeight;
+        StrokeFont::addText(text, "PASS    CPU MS  GPU MS DRAWS  VERTS    KB", left, y, scale);
+        for (int p = 0; p < Profiler::passCount; p++) {
+            const Profiler::PassStats & stats = profiler.getPass(p);
+            y -= lineHeight;
+            snprintf(line, sizeof(line), "%-7s %6.3f  %6.3f %5lu %6lu %5.1f", Profiler::passName(p),
+                    stats.cpuMs, stats.gpuMs, stats.drawCalls, stats.vertices, stats.bytes / 1024.0);
+            StrokeFont::addText(text, line, left, y, scale);
+        }
+        backend->drawArrays(RenderBackend::LINES, vec3(1.0f, 1.0f, 1.0f), &text[0], text.size() / 2);
+
+        // Graphs, the newest frame on the right
+        float bottom = y - lineHeight - 100;
+        graph.resize(Profiler::historyLength * 2);
+        for (int i = 0; i < Profiler::historyLength; i++) {
+            graph[2 * i] = left + Profiler::historyLength * 2 - 2 * i;
+            graph[2 * i + 1] = bottom + fminf(profiler.getIntervalHistory(i), 100);
+        }
+        backend->drawArrays(RenderBackend::LINE_STRIP, vec3(1.0f, 1.0f, 1.0f), &graph[0], Profiler::historyLength);
+        for (int i = 0; i < Profiler::historyLength; i++) {
+            graph[2 * i + 1] = bottom + fminf(profiler.getGpuHistory(i), 100);
+        }
+        backend->drawArrays(RenderBackend::LINE_STRIP, vec3(1.0f, 1.0f, 0.0f), &graph[0], Profiler::historyLength);
+    }
+};
+
+#endif // OVERLAY_H
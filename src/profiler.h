@@ -0,0 +1,200 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+
+/**
+ * Gpu time of the passes of a frame, with GL_TIME_ELAPSED queries.
+ *
+ * Every frame in flight has its own set of queries. A result is read back
+ * only once the gpu reports it available, a few frames later, so reading
+ * never stalls the pipeline. Passes must not nest: only one TIME_ELAPSED
+ * query can run at a time.
+ */
+class GpuTimer {
+public:
+    static const int maxPasses = 8;
+
+private:
+    static const int framesInFlight = 4;
+
+    unsigned int queries[framesInFlight][maxPasses];
+    bool issued[framesInFlight][maxPasses];
+    int frame = 0;
+    double results[maxPasses]; // ms, the latest available
+
+public:
+
+    GpuTimer()
+    {
+        glGenQueries(framesInFlight * maxPasses, &queries[0][0]);
+        for (int f = 0; f < framesInFlight; f++) {
+            for (int p = 0; p < maxPasses; p++) issued[f][p] = false;
+        }
+        for (int p = 0; p < maxPasses; p++) results[p] = 0;
+    }
+
+    /**
+     * Call before the first pass of the frame. Collects the finished queries.
+     */
+    void beginFrame() {
+        frame = (frame + 1) % framesInFlight;
+        // Oldest frame first, so the newest result wins
+        for (int i = 0; i < framesInFlight; i++) {
+            int f = (frame + i) % framesInFlight;
+            for (int p = 0; p < maxPasses; p++) {
+                if (!issued[f][p]) continue;
+                GLint available = 0;
+                glGetQueryObjectiv(queries[f][p], GL_QUERY_RESULT_AVAILABLE, &available);
+                if (!available) continue;
+                GLuint64 ns = 0;
+                glGetQueryObjectui64v(queries[f][p], GL_QUERY_RESULT, &ns);
+                results[p] = ns / 1e6;
+                issued[f][p] = false;
+            }
+        }
+        // Still not finished after framesInFlight frames: reused, the result is lost
+        for (int p = 0; p < maxPasses; p++) issued[frame][p] = false;
+    }
+
+    void begin(int pass) {
+        glBeginQuery(GL_TIME_ELAPSED, queries[frame][pass]);
+        issued[frame][pass] = true;
+    }
+
+    void end() {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+
+    // Gpu time of the pass in the latest frame the gpu has finished, ms
+    double getMs(int pass) const { return results[pass]; }
+
+    // For a pass that did not run: no result until it runs again
+    void forget(int pass) { results[pass] = 0; }
+
+    virtual ~GpuTimer() {
+        glDeleteQueries(framesInFlight * maxPasses, &queries[0][0]);
+    }
+};
+
+/**
+ * Cost of the passes of onDisplay: cpu and gpu time, draw calls, vertices
+ * and bytes written into the StreamBuffer. The counters are differences of
+ * the totals kept by GlRenderBackend and StreamBuffer.
+ *
+ *     profiler->beginFrame();
+ *     profiler->begin(Profiler::SCENE);
+ *     ... draws ...
+ *     profiler->end(Profiler::SCENE);
+ *     profiler->endFrame();
+ */
+class Profiler {
+public:
+    enum Pass { BACKGROUND, SCENE, OVERLAY, passCount };
+
+    struct PassStats {
+        double cpuMs = 0;
+        double gpuMs = 0;
+        unsigned long drawCalls = 0;
+        unsigned long vertices = 0;
+        size_t bytes = 0;
+    };
+
+    // Frames kept for the graphs
+    static const int historyLength = 120;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    GlRenderBackend * backend;
+    StreamBuffer * stream;
+    GpuTimer gpuTimer;
+
+    PassStats passes[passCount];
+    bool begun[passCount]; // in the current frame
+    // At begin() of the running pass
+    Clock::time_point passStart;
+    unsigned long startDrawCalls, startVertices;
+    size_t startBytes;
+
+    Clock::time_point frameStart;
+    bool started = false;
+    double frameIntervalMs = 0; // between the starts of the last two frames
+    double frameCpuMs = 0;      // beginFrame() to endFrame()
+
+    // Ring buffers, the newest frame at historyIndex - 1
+    float intervalHistory[historyLength];
+    float gpuHistory[historyLength];
+    int historyIndex = 0;
+
+public:
+
+    Profiler(GlRenderBackend * backend, StreamBuffer * stream)
+    :backend(backend), stream(stream)
+    {
+        for (int i = 0; i < historyLength; i++) intervalHistory[i] = gpuHistory[i] = 0;
+    }
+
+    static const char * passName(int pass) {
+        static const char * names[passCount] = { "BG", "SCENE", "OVERLAY" };
+        return names[pass];
+    }
+
+    void beginFrame() {
+        Clock::time_point now = Clock::now();
+        if (started) frameIntervalMs = std::chrono::duration<double, std::milli>(now - frameStart).count();
+        frameStart = now;
+        started = true;
+        gpuTimer.beginFrame();
+        for (int p = 0; p < passCount; p++) {
+            passes[p] = PassStats();
+            passes[p].gpuMs = gpuTimer.getMs(p);
+            begun[p] = false;
+        }
+    }
+
+    void begin(Pass pass) {
+        begun[pass] = true;
+        gpuTimer.begin(pass);
+        startDrawCalls = backend->drawCalls;
+        startVertices = backend->vertices;
+        startBytes = stream->bytesWritten;
+        passStart = Clock::now();
+    }
+
+    void end(Pass pass) {
+        PassStats & stats = passes[pass];
+        stats.cpuMs = std::chrono::duration<double, std::milli>(Clock::now() - passStart).count();
+        stats.drawCalls = backend->drawCalls - startDrawCalls;
+        stats.vertices = backend->vertices - startVertices;
+        stats.bytes = stream->bytesWritten - startBytes;
+        gpuTimer.end();
+    }
+
+    void endFrame() {
+        frameCpuMs = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+        // A pass skipped in this frame (the hidden overlay) costs nothing, not its last result
+        for (int p = 0; p < passCount; p++) {
+            if (begun[p]) continue;
+            passes[p].gpuMs = 0;
+            gpuTimer.forget(p);
+        }
+        double gpuMs = 0;
+        for (int p = 0; p < passCount; p++) gpuMs += passes[p].gpuMs;
+        intervalHistory[historyIndex] = frameIntervalMs;
+        gpuHistory[historyIndex] = gpuMs;
+        historyIndex = (historyIndex + 1) % historyLength;
+    }
+
+    const PassStats & getPass(int pass) const { return passes[pass]; }
+    double getFrameIntervalMs() const { return frameIntervalMs; }
+    double getFrameCpuMs() const { return frameCpuMs; }
+
+    /**
+     * @param age - 0 is the newest frame, historyLength - 1 the oldest
+     */
+    float getIntervalHistory(int age) const { return intervalHistory[(historyIndex - 1 - age + 2 * historyLength) % historyLength]; }
+    float getGpuHistory(int age) const { return gpuHistory[(historyIndex - 1 - age + 2 * historyLength) % historyLength]; }
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,244 @@
+#ifndef PROGRAMREGISTRY_H
+#define PROGRAMREGISTRY_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+/**
+ * A linked shader program. Same use as GPUProgram, but it is created and
+ * owned by the ProgramRegistry.
+ */
+class ShaderProgram {
+    friend class ProgramRegistry;
+    unsigned int shaderProgramId = 0;
+public:
+    unsigned int getId() { return shaderProgramId; }
+
+    void Use() { 		// make this program run
+        glUseProgram(shaderProgramId);
+    }
+};
+
+/**
+ * Creates the shader programs. The programs are keyed by the hash of their
+ * sources and of the driver. The linked binaries are stored in `cacheDir`
+ * (glGetProgramBinary), so later runs skip compiling and linking. If a
+ * binary is missing or the driver rejects it, the program is compiled.
+ *
+ * Errors are printed and reported by the return value, nothing blocks.
+ */
+class ProgramRegistry {
+
+    std::string cacheDir;
+    bool binariesSupported;
+    // Programs of this run, so the same sources are linked only once
+    std::map<unsigned long long, unsigned int> programs;
+
+    // 64 bit FNV-1a
+    static unsigned long long hash(unsigned long long h, const char * text) {
+        if (!text) text = "";
+        for (; *text; text++) {
+            h ^= (unsigned char) *text;
+            h *= 1099511628211ULL;
+        }
+        // Separator, so "ab" + "c" and "a" + "bc" differ
+        h ^= 0xff;
+        h *= 1099511628211ULL;
+        return h;
+    }
+
+    std::string fileName(unsigned long long key) {
+        char name[32];
+        sprintf(name, "/%016llx.bin", key);
+        return cacheDir + name;
+    }
+
+    static void printLog(unsigned int handle, bool isProgram) {
+        int logLen = 0, written;
+        if (isProgram) glGetProgramiv(handle, GL_INFO_LOG_LENGTH, &logLen);
+        else glGetShaderiv(handle, GL_INFO_LOG_LENGTH, &logLen);
+        if (logLen > 0) {
+            std::vector<char> log(logLen);
+            if (isProgram) glGetProgramInfoLog(handle, logLen, &written, &log[0]);
+            else glGetShaderInfoLog(handle, logLen, &written, &log[0]);
+            fprintf(stderr, "Shader log:\n%s", &log[0]);
+        }
+    }
+
+    static unsigned int compileShader(GLenum type, const char * const source) {
+        unsigned int shader = glCreateShader(type);
+        if (!shader) {
+            fprintf(stderr, "Error in shader creation\n");
+            return 0;
+        }
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        int OK;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &OK);
+        if (!OK) {
+            fprintf(stderr, "%s shader error!\n", type == GL_VERTEX_SHADER ? "Vertex" : "Fragment");
+            printLog(shader, false);
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+
+    unsigned int compile(const char * const vertexSource, const char * const fragmentSource,
+                         const char * const fragmentShaderOutputName) {
+        unsigned int vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+        unsigned int fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+        if (!vertexShader || !fragmentShader) {
+            if (vertexShader) glDeleteShader(vertexShader);
+            if (fragmentShader) glDeleteShader(fragmentShader);
+            return 0;
+        }
+
+        unsigned int program = glCreateProgram();
+        glAttachShader(program, vertexShader);
+        glAttachShader(program, fragmentShader);
+        // Connect the fragmentColor to the frame buffer memory
+        glBindFragDataLocation(program, 0, fragmentShaderOutputName);
+        if (binariesSupported) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(program);
+        // The program keeps what it needs
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
+        int OK;
+        glGetProgramiv(program, GL_LINK_STATUS, &OK);
+        if (!OK) {
+            fprintf(stderr, "Failed to link shader program!\n");
+            printLog(program, true);
+            glDeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
+
+    // Returns 0 if there is no usable binary
+    unsigned int loadBinary(unsigned long long key) {
+        FILE * file = fopen(fileName(key).c_str(), "rb");
+        if (!file) return 0;
+
+        GLenum format;
+        std::vector<char> binary;
+        bool ok = fread(&format, sizeof(format), 1, file) == 1;
+        if (ok) {
+            fseek(file, 0, SEEK_END);
+            long size = ftell(file) - (long) sizeof(format);
+            fseek(file, sizeof(format), SEEK_SET);
+            ok = size > 0;
+            if (ok) {
+                binary.resize(size);
+                ok = fread(&binary[0], 1, size, file) == (size_t) size;
+            }
+        }
+        fclose(file);
+        if (!ok) return 0;
+
+        unsigned int program = glCreateProgram();
+        glProgramBinary(program, format, &binary[0], binary.size());
+        int OK;
+        glGetProgramiv(program, GL_LINK_STATUS, &OK);
+        if (!OK) { // e.g. the driver was updated
+            glDeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
+
+    void saveBinary(unsigned long long key, unsigned int program) {
+        int length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+        std::vector<char> binary(length);
+        GLenum format;
+        glGetProgramBinary(program, length, &length, &format, &binary[0]);
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+        _mkdir(cacheDir.c_str());
+#else
+        mkdir(cacheDir.c_str(), 0755);
+#endif
+        FILE * file = fopen(fileName(key).c_str(), "wb");
+        if (!file) {
+            fprintf(stderr, "Cannot write the shader cache in %s\n", cacheDir.c_str());
+            return;
+        }
+        fwrite(&format, sizeof(format), 1, file);
+        fwrite(&binary[0], 1, length, file);
+        fclose(file);
+    }
+
+public:
+
+    /**
+     * Needs a current OpenGL context.
+     * @param cacheDir - Directory of the program binaries, created on demand
+     */
+    ProgramRegistry(const char * cacheDir = "shadercache")
+    :cacheDir(cacheDir)
+    {
+        int formats = 0;
+#if !defined(__APPLE__)
+        if (GLEW_ARB_get_program_binary) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+#endif
+        binariesSupported = formats > 0;
+    }
+
+    /**
+     * Creates the program from the sources, from the cache if possible,
+     * and makes it run.
+     * @return - false if the program could not be compiled or linked
+     */
+    bool load(ShaderProgram & program, const char * const vertexSource, const char * const fragmentSource,
+              const char * const fragmentShaderOutputName) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        unsigned long long key = 14695981039346656037ULL;
+        key = hash(key, vertexSource);
+        key = hash(key, fragmentSource);
+        key = hash(key, fragmentShaderOutputName);
+        // Binaries are only valid for the driver that made them
+        key = hash(key, (const char *) glGetString(GL_VENDOR));
+        key = hash(key, (const char *) glGetString(GL_RENDERER));
+        key = hash(key, (const char *) glGetString(GL_VERSION));
+
+        const char * source = "registry";
+        unsigned int id = programs.count(key) ? programs[key] : 0;
+        if (!id && binariesSupported) {
+            id = loadBinary(key);
+            source = "cache";
+        }
+        if (!id) {
+            id = compile(vertexSource, fragmentSource, fragmentShaderOutputName);
+            source = "sources";
+            if (!id) return false;
+            if (binariesSupported) saveBinary(key, id);
+        }
+        programs[key] = id;
+        program.shaderProgramId = id;
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        fprintf(stderr, "Program %016llx from %s in %.2f ms\n", key, source, ms);
+
+        program.Use();
+        return true;
+    }
+
+    virtual ~ProgramRegistry() {
+        std::map<unsigned long long, unsigned int>::iterator it;
+        for (it = programs.begin(); it != programs.end(); ++it) glDeleteProgram(it->second);
+    }
+};
+
+#endif // PROGRAMREGISTRY_H
@@ -0,0 +1,19 @@
+#ifndef RENDERBACKEND_H
+#define RENDERBACKEND_H
+
+/**
+ * What the drawers draw with. The vertices are x, y pairs in world
+ * coordinates, the backend transforms them with the view-projection matrix.
+ */
+class RenderBackend {
+public:
+    enum Primitive { LINE_STRIP, LINES, TRIANGLE_STRIP };
+
+    virtual void setViewProjection(mat4 viewProjection) = 0;
+
+    virtual void drawArrays(Primitive primitive, vec3 color, const float * vertices, int vertexCount) = 0;
+
+    virtual ~RenderBackend() {}
+};
+
+#endif // RENDERBACKEND_H
@@ -0,0 +1,165 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * Everything the GL thread needs to draw a frame. Immutable once published.
+ */
+struct FrameSnapshot {
+    std::vector<float> groundVertices; // GroundDrawer::generate
+    std::vector<float> circleVertices; // CircleDrawer::generate
+    vec2 circleCenter;
+};
+
+/**
+ * Runs the simulation and builds the vertex data on a worker thread.
+ *
+ * The GL thread asks for the next step with requestStep() and meanwhile
+ * draws the last published snapshot, so the simulation of frame n + 1
+ * overlaps the drawing of frame n. There are two snapshots: the worker
+ * fills the back one while the GL thread reads the front one, and they are
+ * swapped when the GL thread is not reading.
+ *
+ * After the worker is started, only it may touch the circle. The ground can
+ * be edited from any thread (see BasicSpline), the next step picks it up.
+ */
+class Simulation {
+
+    Spline * ground;
+    Circle * circle;
+    CircleController * control;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    // Guarded by mutex
+    FrameSnapshot snapshots[2];
+    int front = 0;              // the published snapshot, only the worker changes it
+    bool reading = false;       // the GL thread holds the front snapshot
+    bool newChanges = false;    // a changed snapshot was published since the last poll()
+    bool stepRequested = false;
+    bool running = true;
+    // Level of detail of the wheel
+    float pixelsPerUnit = 1;
+    float maxPixelError = 0.5f;
+    bool lodChanged = false;    // the wheel has to be regenerated at the new level
+    // The version of the ground in the last snapshot, only the worker uses it
+    unsigned int groundVersion;
+
+    void prepare(FrameSnapshot & snapshot, float pixelsPerUnit, float maxPixelError) {
+        GroundDrawer::generate(ground, snapshot.groundVertices);
+        CircleDrawer::generate(circle, snapshot.circleVertices, pixelsPerUnit, maxPixelError);
+        snapshot.circleCenter = asvec2(circle->center);
+    }
+
+    void run() {
+        while (true) {
+            float lodPixelsPerUnit, lodMaxPixelError;
+            bool lodLevelChanged;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this] { return stepRequested || !running; });
+                if (!running) return;
+                stepRequested = false;
+                lodPixelsPerUnit = pixelsPerUnit;
+                lodMaxPixelError = maxPixelError;
+                lodLevelChanged = lodChanged;
+                lodChanged = false;
+            }
+
+            // Simulation and vertex generation, without holding the lock
+            unsigned int version = ground->getVersion();
+            bool changed = version != groundVersion || lodLevelChanged;
+            groundVersion = version;
+            if (control->tick()) changed = true;
+            prepare(snapshots[1 - front], lodPixelsPerUnit, lodMaxPixelError);
+
+            // Publish
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this] { return !reading || !running; });
+                if (!running) return;
+                front = 1 - front;
+                if (changed) newChanges = true;
+            }
+        }
+    }
+
+public:
+
+    Simulation(Spline * ground, Circle * circle, CircleController * control)
+    :ground(ground), circle(circle), control(control)
+    {
+        // So there is something to draw before the first step
+        groundVersion = ground->getVersion();
+        prepare(snapshots[front], pixelsPerUnit, maxPixelError);
+        worker = std::thread(&Simulation::run, this);
+    }
+
+    // Starts computing the next snapshot in the background
+    void requestStep() {
+        std::lock_guard<std::mutex> lock(mutex);
+        stepRequested = true;
+        condition.notify_all();
+    }
+
+    /**
+     * @return - Whether a snapshot with changes was published since the last call
+     */
+    bool poll() {
+        std::lock_guard<std::mutex> lock(mutex);
+        bool changes = newChanges;
+        newChanges = false;
+        return changes;
+    }
+
+    /**
+     * Level of detail of the wheels from the next step on. Cheap when
+     * nothing changed, so it can be called every frame.
+     * @param pixelsPerUnit - Camera::getPixelsPerUnit()
+     * @param maxPixelError - Allowed distance of the drawn rim from the true circle
+     */
+    void setLodParameters(float pixelsPerUnit, float maxPixelError = 0.5f) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pixelsPerUnit == this->pixelsPerUnit && maxPixelError == this->maxPixelError) return;
+        this->pixelsPerUnit = pixelsPerUnit;
+        this->maxPixelError = maxPixelError;
+        lodChanged = true;
+    }
+
+    /**
+     * The latest snapshot. It stays valid (and is not swapped) until release().
+     */
+    const FrameSnapshot & acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        reading = true;
+        return snapshots[front];
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        reading = false;
+        condition.notify_all();
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) return;
+            running = false;
+            condition.notify_all();
+        }
+        worker.join();
+    }
+
+    virtual ~Simulation() {
+        stop();
+    }
+};
+
+#endif // SIMULATION_H
@@ -1,25 +1,332 @@
 #ifndef GROUND_H
 #define GROUND_H
-class Spline {
 
-    vec2 end;
-    std::vector<vec2> cPoints = std::vector<vec2>();
-    vec2 afterEnd;
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <math.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <new>
+#include <stdint.h>
+
+/**
+ * Curve through the control points, the shape of a segment comes from Basis
+ * (see splinebasis.h).
+ *
+ * The coefficients of every segment are cached together with an arc length
+ * table: each segment is cut into a few pieces and the length of the pieces
+ * is integrated with Gauss-Legendre quadrature. Arc lengths are measured on
+ * the curve without the transformationMatrix, from the start point.
+ *
+ * The curve can be edited while other threads read it. The control points
+ * and the cache form an immutable Data version. add() copies the current
+ * version, changes the copy and publishes it with one atomic store, so the
+ * readers never lock: read() pins the current version in a hazard slot,
+ * and a replaced version is deleted once no slot holds it. The writers are
+ * serialized by a mutex. The transformationMatrix is not versioned, only
+ * the thread drawing the curve may change it.
+ */
+template <class Basis>
+class BasicSpline {
+
+    // Pieces of a segment in the arc length table
+    static const int pieces = 4;
+
+    struct Segment {
+        float x0, x1;
+        float c[4];
+        float s0;                 // arc length at x0
+        float length[pieces + 1]; // arc length from x0 to the end of the pieces, length[0] = 0
+    };
+
+    // dy/dx on the segment
+    static float slope(const Segment & segment, float x) {
+        float w = segment.x1 - segment.x0;
+        float t = (x - segment.x0) / w;
+        return ((3 * segment.c[3] * t + 2 * segment.c[2]) * t + segment.c[1]) / w;
+    }
+
+    // Length of the curve of the segment between a and b, 5 point Gauss-Legendre
+    static float gaussLegendre(const Segment & segment, float a, float b) {
+        static const float node[5] = { 0.0f, -0.5384693101f, 0.5384693101f, -0.9061798459f, 0.9061798459f };
+        static const float weight[5] = { 0.5688888889f, 0.4786286705f, 0.4786286705f, 0.2369268851f, 0.2369268851f };
+        float half = (b - a) / 2, mid = (a + b) / 2;
+        float sum = 0;
+        for (int i = 0; i < 5; i++) {
+            float dy = slope(segment, mid + half * node[i]);
+            sum += weight[i] * sqrt(1 + dy * dy);
+        }
+        return sum * half;
+    }
+
+    // Length of the curve of the segment between a and b. On a steep curve the
+    // length bends sharply where the slope turns, so the quadrature is split there.
+    static float integrate(const Segment & segment, float a, float b) {
+        // The roots of dy/dt = c1 + 2 c2 t + 3 c3 t^2 between a and b
+        float w = segment.x1 - segment.x0;
+        float ta = (a - segment.x0) / w, tb = (b - segment.x0) / w;
+        if (ta > tb) { float tmp = ta; ta = tb; tb = tmp; }
+        float qa = 3 * segment.c[3], qb = 2 * segment.c[2], qc = segment.c[1];
+        float roots[2];
+        int count = 0;
+        if (fabsf(qa) > 1e-12f) {
+            float discriminant = qb * qb - 4 * qa * qc;
+            if (discriminant > 0) {
+                float root = sqrt(discriminant);
+                roots[0] = (-qb - root) / (2 * qa);
+                roots[1] = (-qb + root) / (2 * qa);
+                if (roots[0] > roots[1]) { float tmp = roots[0]; roots[0] = roots[1]; roots[1] = tmp; }
+                count = 2;
+            }
+        } else if (fabsf(qb) > 1e-12f) {
+            roots[0] = -qc / qb;
+            count = 1;
+        }
+
+        float sum = 0, from = ta;
+        for (int i = 0; i < count; i++) {
+            if (roots[i] <= from || roots[i] >= tb) continue;
+            sum += gaussLegendre(segment, segment.x0 + from * w, segment.x0 + roots[i] * w);
+            from = roots[i];
+        }
+        sum += gaussLegendre(segment, segment.x0 + from * w, segment.x0 + tb * w);
+        return b < a ? -sum : sum;
+    }
+
+public:
+
+    /**
+     * One version of the curve, never changes once published.
+     */
+    class Data {
+        friend class BasicSpline;
+
+        std::vector<vec2> cPoints;
+        // segments[i] is the curve from cPoints[i + 1] to cPoints[i + 2]
+        std::vector<Segment> segments;
+        // Changes whenever the control points do
+        unsigned int version = 0;
+
+        // The segment of x, the first or the last one outside the curve
+        int segmentAt(float x) const {
+            int low = 0, high = segments.size() - 1;
+            while (low < high) {
+                int middle = (low + high + 1) / 2;
+                if (segments[middle].x0 <= x) low = middle;
+                else high = middle - 1;
+            }
+            return low;
+        }
+
+    public:
+
+        unsigned int getVersion() const { return version; }
+
+        /**
+         * The point of the curve without the transformationMatrix applied.
+         * @param x - Ranges between 0 and the width of the screen
+         */
+        vec2 localR(float x) const {
+            if (!(cPoints.front().x <= x && x <= cPoints.back().x)) {
+                LOG_WARN("Spline: previous point not found for x = %.2f", x);
+                // The first or the last segment is extrapolated
+            }
+            const Segment & segment = segments[segmentAt(x)];
+            float t = (x - segment.x0) / (segment.x1 - segment.x0);
+            float y = ((segment.c[3] * t + segment.c[2]) * t + segment.c[1]) * t + segment.c[0];
+            return vec2(x, y);
+        }
+
+        // Length of the whole curve, from the start point to the end point
+        float totalArcLength() const {
+            const Segment & last = segments.back();
+            return last.s0 + last.length[pieces];
+        }
+
+        /**
+         * Arc length from the start point to x, negative before the start point.
+         * @param x - Ranges between 0 and the width of the screen
+         */
+        float arcLength(float x) const {
+            const Segment & segment = segments[segmentAt(x)];
+            float w = (segment.x1 - segment.x0) / pieces;
+            int k = (int) floorf((x - segment.x0) / w);
+            if (k < 0) k = 0;
+            if (k > pieces - 1) k = pieces - 1;
+            float xk = segment.x0 + k * w;
+            return segment.s0 + segment.length[k] + integrate(segment, xk, x);
+        }
+
+        /**
+         * The x where the arc length from the start point is s, the inverse of arcLength().
+         * @param s - Ranges between 0 and totalArcLength()
+         */
+        float xAtArcLength(float s) const {
+            // The segment and the piece
+            int low = 0, high = segments.size() - 1;
+            while (low < high) {
+                int middle = (low + high + 1) / 2;
+                if (segments[middle].s0 <= s) low = middle;
+                else high = middle - 1;
+            }
+            const Segment & segment = segments[low];
+            float local = s - segment.s0;
+            int k = 0;
+            while (k < pieces - 1 && segment.length[k + 1] <= local) k++;
+
+            // Newton's method on the length in the piece, ds/dx = sqrt(1 + dy^2).
+            // Inside the curve it is kept in the piece, bisecting when a step leaves it.
+            float w = (segment.x1 - segment.x0) / pieces;
+            float xk = segment.x0 + k * w;
+            float target = local - segment.length[k];
+            float pieceLength = segment.length[k + 1] - segment.length[k];
+            float x = xk + (pieceLength > 0 ? target / pieceLength * w : 0);
+            bool inside = s >= 0 && s <= totalArcLength();
+            float left = xk, right = xk + w;
+            for (int i = 0; i < 16; i++) {
+                float error = integrate(segment, xk, x) - target;
+                if (fabsf(error) < 1e-5f * (1 + fabsf(target))) break;
+                if (error < 0) left = x;
+                else right = x;
+                float dy = slope(segment, x);
+                x -= error / sqrt(1 + dy * dy);
+                if (inside && !(left < x && x < right)) x = (left + right) / 2;
+            }
+            return x;
+        }
+    };
+
+    /**
+     * Pins a version of the curve while it is alive, see read().
+     */
+    class Reader {
+        const BasicSpline * spline;
+        const Data * data;
+        int slot;
+
+        Reader(const Reader &);
+        Reader & operator=(const Reader &);
+    public:
+        Reader(const BasicSpline * spline, const Data * data, int slot)
+        :spline(spline), data(data), slot(slot)
+        {}
+
+        Reader(Reader && other)
+        :spline(other.spline), data(other.data), slot(other.slot)
+        {
+            other.slot = -1;
+        }
+
+        const Data * operator->() const { return data; }
+
+        // Data::localR with the transformationMatrix of the spline applied
+        vec2 r(float x) const {
+            return asvec2(asvec4(data->localR(x)) * spline->transformationMatrix);
+        }
+
+        ~Reader() {
+            if (slot >= 0) spline->unpin(slot);
+        }
+    };
+
+private:
+
+    // At most this many readers at the same time, the others wait for a slot
+    static const int hazardSlots = 16;
+    static const int cacheLine = 64;
+
+    // Exactly one cache line, so readers pinning in different slots do not share lines
+    struct HazardSlot {
+        std::atomic<const Data *> data;
+        std::atomic<bool> taken;
+        char padding[cacheLine - sizeof(std::atomic<const Data *>) - sizeof(std::atomic<bool>)];
+    };
+    static_assert(sizeof(HazardSlot) == cacheLine, "a hazard slot must fill a cache line");
+
+    std::atomic<const Data *> current;
+    // slots[hazardSlots] in slotStorage, aligned to a cache line by hand:
+    // new does not honour alignas beyond the fundamental alignment in C++11
+    char * slotStorage;
+    HazardSlot * slots;
+    std::mutex writer;
+    std::vector<const Data *> retired; // guarded by writer
     static bool orderByX(vec2 left, vec2 last) { return left.x < last.x; }
-    float tension;
+    Basis basis;
+
+    void unpin(int slot) const {
+        slots[slot].data.store(NULL);
+        slots[slot].taken.store(false, std::memory_order_release);
+    }
+
+    // Recomputes data.segments[from..to] and the arc lengths of every segment from `from`
+    void rebuild(Data & data, int from, int to) {
+        std::vector<vec2> & cPoints = data.cPoints;
+        std::vector<Segment> & segments = data.segments;
+        if (from < 0) from = 0;
+        if (to > (int) segments.size() - 1) to = segments.size() - 1;
+        for (int i = from; i <= to; i++) {
+            Segment & segment = segments[i];
+            vec2 p[4] = { cPoints[i], cPoints[i + 1], cPoints[i + 2], cPoints[i + 3] };
+            basis.coefficients(p, segment.c);
+            segment.x0 = p[1].x;
+            segment.x1 = p[2].x;
+            segment.length[0] = 0;
+            float w = (segment.x1 - segment.x0) / pieces;
+            for (int k = 0; k < pieces; k++) {
+                // Two points at the same x make an empty segment, it has no length
+                float piece = w > 0 ? integrate(segment, segment.x0 + k * w, segment.x0 + (k + 1) * w) : 0;
+                segment.length[k + 1] = segment.length[k] + piece;
+            }
+        }
+        for (int i = from; i < segments.size(); i++) {
+            segments[i].s0 = i == 0 ? 0 : segments[i - 1].s0 + segments[i - 1].length[pieces];
+        }
+    }
+
+    // Makes next the current version, deletes the old versions no reader holds
+    void publish(Data * next) {
+        retired.push_back(current.load(std::memory_order_relaxed));
+        current.store(next);
+        for (int i = 0; i < retired.size(); ) {
+            bool pinned = false;
+            for (int slot = 0; slot < hazardSlots; slot++) {
+                if (slots[slot].data.load() == retired[i]) pinned = true;
+            }
+            if (pinned) {
+                i++;
+            } else {
+                delete retired[i];
+                retired[i] = retired.back();
+                retired.pop_back();
+            }
+        }
+    }
+
 public:
-    Spline(vec2 start, vec2 end, float tension)
-    :end(end), tension(tension)
+    BasicSpline(vec2 start, vec2 end, Basis basis = Basis())
+    :basis(basis)
     {
+	Data * data = new Data();
 	vec2 beforeStart = vec2(start);
 	beforeStart.x -= 10;
-	afterEnd = vec2(end);
+	vec2 afterEnd = vec2(end);
 	afterEnd.x += 10;
-	cPoints.push_back(beforeStart);
-	cPoints.push_back(start);
-	cPoints.push_back(end);
-	cPoints.push_back(afterEnd);
-	
+	data->cPoints.push_back(beforeStart);
+	data->cPoints.push_back(start);
+	data->cPoints.push_back(end);
+	data->cPoints.push_back(afterEnd);
+	data->segments.resize(1);
+	rebuild(*data, 0, 0);
+	current.store(data);
+	slotStorage = new char[hazardSlots * sizeof(HazardSlot) + cacheLine - 1];
+	slots = (HazardSlot *) (((uintptr_t) slotStorage + cacheLine - 1) & ~(uintptr_t) (cacheLine - 1));
+	for (int i = 0; i < hazardSlots; i++) {
+	    new (&slots[i]) HazardSlot();
+	    slots[i].data.store(NULL);
+	    slots[i].taken.store(false);
+	}
     }
 
     mat4 transformationMatrix = mat4(
@@ -30,164 +337,183 @@ public:
             );
 
     void add(vec2 point) { 
-	// Keep the vec2 end at the end.
-	cPoints.push_back(point); 
+        std::lock_guard<std::mutex> lock(writer);
+        Data * next = new Data(*current.load(std::memory_order_relaxed));
         // The clicked point should be sorted according to the x coordinate
-        std::sort(cPoints.begin(), cPoints.end(), orderByX);
+        int k = std::upper_bound(next->cPoints.begin(), next->cPoints.end(), point, orderByX) - next->cPoints.begin();
+        next->cPoints.insert(next->cPoints.begin() + k, point);
+        // Only the segments with the new point among their four points change
+        int first = k - 3 < 0 ? 0 : k - 3;
+        next->segments.insert(next->segments.begin() + (first < next->segments.size() ? first : next->segments.size()), Segment());
+        rebuild(*next, first, k);
+        next->version++;
+        publish(next);
+    }
+
+    // Adds many points with a single sort
+    void add(const std::vector<vec2> & points) {
+        std::lock_guard<std::mutex> lock(writer);
+        Data * next = new Data(*current.load(std::memory_order_relaxed));
+        next->cPoints.insert(next->cPoints.end(), points.begin(), points.end());
+        std::sort(next->cPoints.begin(), next->cPoints.end(), orderByX);
+        next->segments.resize(next->cPoints.size() - 3);
+        rebuild(*next, 0, next->segments.size() - 1);
+        next->version++;
+        publish(next);
     }
 
+    /**
+     * Pins the current version, it stays valid while the Reader is alive.
+     * Use one Reader for many queries, each query below pins on its own.
+     */
+    Reader read() const {
+        // A free slot
+        int slot = 0;
+        while (true) {
+            bool expected = false;
+            if (!slots[slot].taken.load(std::memory_order_relaxed)
+                    && slots[slot].taken.compare_exchange_weak(expected, true, std::memory_order_acquire)) break;
+            slot = (slot + 1) % hazardSlots;
+            if (slot == 0) std::this_thread::yield();
+        }
+        // Announce the version, valid if it is still the current one after that
+        const Data * data = current.load();
+        while (true) {
+            slots[slot].data.store(data);
+            const Data * again = current.load();
+            if (again == data) break;
+            data = again;
+        }
+        return Reader(this, data, slot);
+    }
+
+    unsigned int getVersion() const { return read()->getVersion(); }
+
     /**
      * @param x - Ranges between 0 and the width of the screen
      */
-    vec2 r(float x) {
-        // The variables used in the formula
-        float x0, x1, x2, x3, y0, y1, y2, y3, dy1, dy2;
-        // 1. Preparing variables
-        
-        int index = -1;
-        for (int i = 0; i < cPoints.size(); i++) {
-            if ( cPoints[i].x <= x && x <= cPoints[i+1].x  ) {
-                index = i;
-                break;
-            }
-        } 
-        if (index == -1) {
-            std::cout << "Previous point not found";
-        }
-
-        // Declare points and calculate indexes in cPoints to them
-        vec2 p0, p1, p2, p3;
-        int index0, index1, index2, index3;
-        
-	index0 = index - 1;
-	index1 = index;
-	index2 = index + 1;
-	index3 = index + 2;
-
-	p0 = cPoints[index0]; p1 = cPoints[index1];
-	p2 = cPoints[index2]; p3 = cPoints[index3];
-
-        x0 = p0.x; y0 = p0.y;
-        x1 = p1.x; y1 = p1.y;
-        x2 = p2.x; y2 = p2.y;
-        x3 = p3.x; y3 = p3.y;
-
-        // 2. The formula 
-        dy1 = (1 - tension) * (
-                (y1 - y0) / (x1 - x0)
-                +
-                (y2 - y1) / (x2 - x1)
-                );
-        dy2 = (1 - tension) * (
-                (y2 - y1) / (x2 - x1)
-                +
-                (y3 - y2) / (x3 - x2)
-                );
-        float a0 = y1;
-        float a1 = dy1;
-        float a2 = 
-            ( 3 * (y2 - y1) ) / ( (float) pow(x2 - x1, 2) )
-            -
-            ( dy2 + 2 * dy1 ) / ( x2 - x1 );
-        float a3 = 
-            ( 2 * (y1 - y2) ) / ( (float) pow(x2 - x1, 3) )
-            +
-            ( dy2 + dy1 ) / ( (float) pow(x2 - x1, 2) );
-        float y = a3 * std::pow(x - x1, 3) 
-             + a2 * std::pow(x - x1, 2) 
-             + a1 * (x - x1) 
-             + a0;
-        return asvec2(vec4(x, y, 0, 1) * this->transformationMatrix);
+    vec2 r(float x) const { return read().r(x); }
+
+    /**
+     * The point of the curve without the transformationMatrix applied.
+     * @param x - Ranges between 0 and the width of the screen
+     */
+    vec2 localR(float x) const { return read()->localR(x); }
+
+    float totalArcLength() const { return read()->totalArcLength(); }
+
+    float arcLength(float x) const { return read()->arcLength(x); }
+
+    float xAtArcLength(float s) const { return read()->xAtArcLength(s); }
+
+    // No reader may be left
+    ~BasicSpline() {
+        delete current.load();
+        for (int i = 0; i < retired.size(); i++) delete retired[i];
+        for (int i = 0; i < hazardSlots; i++) slots[i].~HazardSlot();
+        delete[] slotStorage;
     }
     
 };
 
+// The ground can be edited, its tension is given at run time
+typedef BasicSpline<CardinalBasis> Spline;
+// The background never changes shape, its tension is folded into the code
+typedef BasicSpline<FixedCardinalBasis<15> > BgSpline;
+
 class GroundDrawer {
-    Spline * ground;
-    unsigned int vao;
-    unsigned int vbo;
+    RenderBackend * backend;
 public:
-    GroundDrawer(Spline * ground)
-    :ground(ground)
-    {
-	glGenVertexArrays(1, &vao);
-	glGenBuffers(1, &vbo);
-    }
-
-    void draw() {
-        int location = glGetUniformLocation(gpuProgram.getId(), "color");
-        glUniform3f(location, 0.0f, 1.0f, 0.0f); // 3 floats
-	glBindVertexArray(vao);		// make it active
+    GroundDrawer(RenderBackend * backend)
+    :backend(backend)
+    {}
 
-	unsigned int vbo;		// vertex buffer object
-	glGenBuffers(1, &vbo);	// Generate 1 buffer
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	// Geometry with 24 bytes (6 floats or 3 x 2 coordinates)
-	float vertices[windowWidth * 4];
+    /**
+     * Builds the triangle strip under the ground, does not need OpenGL.
+     */
+    static void generate(Spline * ground, std::vector<float> & vertices) {
+	Spline::Reader shape = ground->read(); // one version for the whole strip
+	vertices.resize(windowWidth * 4);
 	int quatroStep = 0;
 	for (int i = 0; i < windowWidth; i++){
-            float x = ground->r(i).x;
-	    vertices[quatroStep] = x;
-	    vertices[quatroStep+1] = ground->r(i).y;
-	    vertices[quatroStep+2] = x;
+            vec2 point = shape.r(i);
+	    vertices[quatroStep] = point.x;
+	    vertices[quatroStep+1] = point.y;
+	    vertices[quatroStep+2] = point.x;
 	    vertices[quatroStep+3] = -500;
 
 	    quatroStep += 4;
 	}
-	glBufferData(GL_ARRAY_BUFFER, 	// Copy to GPU target
-		sizeof(vertices),  // # bytes
-		vertices,	      	// address
-		GL_DYNAMIC_DRAW);	// we do not change later
-
+    }
 
-	glEnableVertexAttribArray(0);  // AttribArray 0
-	glVertexAttribPointer(0,       // vbo -> AttribArray 0
-		2, GL_FLOAT, GL_FALSE, // two floats/attrib, not fixed-point
-		0, NULL); 		     // stride, offset: tightly packed
-	glDrawArrays(GL_TRIANGLE_STRIP, 0 /*startIdx*/, windowWidth * 2 /*Pair of elements*/);
+    /**
+     * @param vertices - Made by generate()
+     */
+    void draw(const std::vector<float> & vertices) {
+	if (vertices.empty()) return;
+	backend->drawArrays(RenderBackend::TRIANGLE_STRIP, vec3(0.0f, 1.0f, 0.0f), &vertices[0], vertices.size() / 2);
     }
 };
 
+/**
+ * Draws a background layer as a line strip, moved by the transformationMatrix
+ * of the layer. Works with any RenderBackend; the strip is generated again
+ * only when the control points change. Use one BgDrawer per parallax layer,
+ * on OpenGL CachedBgDrawer draws the layer from a texture instead.
+ */
 class BgDrawer {
-    Spline * ground;
-    unsigned int vao;
-    unsigned int vbo;
-public:
-    BgDrawer(Spline * ground)
-    :ground(ground)
-    {
-	glGenVertexArrays(1, &vao);
-	glGenBuffers(1, &vbo);
+protected:
+    BgSpline * ground;
+    std::vector<float> vertices; // in the local coordinates of the layer
+    bool generated = false;
+    unsigned int generatedVersion;
+
+    /**
+     * @return - Whether the vertices had to be generated again
+     */
+    bool update() {
+        unsigned int version = ground->getVersion();
+        if (generated && generatedVersion == version) return false;
+        generate(ground, vertices);
+        generated = true;
+        generatedVersion = version;
+        return true;
     }
 
-    void draw() {
-        int location = glGetUniformLocation(gpuProgram.getId(), "color");
-        glUniform3f(location, 0.0f, 1.0f, 0.0f); // 3 floats
-	glBindVertexArray(vao);		// make it active
+private:
+    RenderBackend * backend;
 
-	unsigned int vbo;		// vertex buffer object
-	glGenBuffers(1, &vbo);	// Generate 1 buffer
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	// Geometry with 24 bytes (6 floats or 3 x 2 coordinates)
-	float vertices[windowWidth * 2];
+public:
+    BgDrawer(BgSpline * ground, RenderBackend * backend)
+    :ground(ground), backend(backend)
+    {}
+
+    /**
+     * Builds the line strip of the layer in its local coordinates.
+     */
+    static void generate(BgSpline * ground, std::vector<float> & vertices) {
+	BgSpline::Reader shape = ground->read();
+	vertices.resize(windowWidth * 2);
 	int doubleStep = 0;
 	for (int i = 0; i < windowWidth; i++){
-	    vertices[doubleStep] = ground->r(i).x;
-	    vertices[doubleStep+1] = ground->r(i).y;
+            vec2 point = shape->localR(i);
+	    vertices[doubleStep] = point.x;
+	    vertices[doubleStep+1] = point.y;
 	    doubleStep += 2;
 	}
-	glBufferData(GL_ARRAY_BUFFER, 	// Copy to GPU target
-		sizeof(vertices),  // # bytes
-		vertices,	      	// address
-		GL_DYNAMIC_DRAW);	// we do not change later
-
+    }
 
-	glEnableVertexAttribArray(0);  // AttribArray 0
-	glVertexAttribPointer(0,       // vbo -> AttribArray 0
-		2, GL_FLOAT, GL_FALSE, // two floats/attrib, not fixed-point
-		0, NULL); 		     // stride, offset: tightly packed
-	glDrawArrays(GL_LINE_STRIP, 0 /*startIdx*/, windowWidth /*Pair of elements*/);
+    /**
+     * @param viewProjection - The camera matrix, loaded into the backend on return
+     */
+    virtual void draw(mat4 viewProjection) {
+        update();
+        backend->setViewProjection(ground->transformationMatrix * viewProjection);
+        backend->drawArrays(RenderBackend::LINE_STRIP, vec3(0.0f, 1.0f, 0.0f), &vertices[0], vertices.size() / 2);
+        backend->setViewProjection(viewProjection);
     }
+
+    virtual ~BgDrawer() {}
 };
 
 #endif // GROUND_H
@@ -0,0 +1,124 @@
+#ifndef SPLINEBASIS_H
+#define SPLINEBASIS_H
+
+/**
+ * Basis policies for Spline.
+ *
+ * A policy turns the four control points around a segment (p0, p1, p2, p3)
+ * into the coefficients c0..c3 of the cubic on the segment p1 -> p2:
+ *
+ *     y = c0 + c1 * t + c2 * t^2 + c3 * t^3,   t = (x - x1) / (x2 - x1)
+ *
+ * The basis matrices are constexpr, and the policies with their parameters
+ * in template arguments fold them into a handful of multiplications.
+ */
+
+// Rows are the coefficients of 1, t, t^2, t^3 for the geometry (p1, p2, m1, m2)
+constexpr float hermiteBasis[4][4] = {
+    { 1,  0,  0,  0},
+    { 0,  0,  1,  0},
+    {-3,  3, -2, -1},
+    { 2, -2,  1,  1}
+};
+
+// Rows are the coefficients of 1, t, t^2, t^3 for the geometry (p0, p1, p2, p3), times 1/6
+constexpr float bSplineBasis[4][4] = {
+    { 1,  4,  1,  0},
+    {-3,  0,  3,  0},
+    { 3, -6,  3,  0},
+    {-1,  3, -3,  1}
+};
+
+inline void splineApplyBasis(const float (&basis)[4][4], float scale, const float (&g)[4], float (&c)[4]) {
+    for (int i = 0; i < 4; i++) {
+        c[i] = scale * (basis[i][0] * g[0] + basis[i][1] * g[1] + basis[i][2] * g[2] + basis[i][3] * g[3]);
+    }
+}
+
+// Slope of the chord a -> b
+inline float splineSlope(vec2 a, vec2 b) {
+    return (b.y - a.y) / (b.x - a.x);
+}
+
+/**
+ * @param m1, m2 - Slopes (dy/dx) at p1 and p2
+ */
+inline void splineHermite(const vec2 (&p)[4], float m1, float m2, float (&c)[4]) {
+    float h = p[2].x - p[1].x;
+    // The basis works in t, so the slopes are scaled to dy/dt
+    float g[4] = { p[1].y, p[2].y, m1 * h, m2 * h };
+    splineApplyBasis(hermiteBasis, 1, g, c);
+}
+
+/**
+ * Hermite curve with cardinal tangents: the slope at a point is
+ * (1 - tension) * (sum of the slopes of the two chords meeting there).
+ * The tension is given at run time.
+ */
+struct CardinalBasis {
+    float tension;
+
+    CardinalBasis(float tension = 0)
+    :tension(tension)
+    {}
+
+    void coefficients(const vec2 (&p)[4], float (&c)[4]) const {
+        float s01 = splineSlope(p[0], p[1]);
+        float s12 = splineSlope(p[1], p[2]);
+        float s23 = splineSlope(p[2], p[3]);
+        splineHermite(p, (1 - tension) * (s01 + s12), (1 - tension) * (s12 + s23), c);
+    }
+};
+
+/**
+ * CardinalBasis with the tension TensionNum / TensionDen fixed at compile time.
+ */
+template <int TensionNum, int TensionDen = 10>
+struct FixedCardinalBasis {
+    static constexpr float tension = (float) TensionNum / TensionDen;
+
+    void coefficients(const vec2 (&p)[4], float (&c)[4]) const {
+        float s01 = splineSlope(p[0], p[1]);
+        float s12 = splineSlope(p[1], p[2]);
+        float s23 = splineSlope(p[2], p[3]);
+        splineHermite(p, (1 - tension) * (s01 + s12), (1 - tension) * (s12 + s23), c);
+    }
+};
+
+/**
+ * Kochanek-Bartels tangents, tension, continuity and bias are Param / Den.
+ */
+template <int TensionNum, int ContinuityNum, int BiasNum, int Den = 10>
+struct KochanekBartelsBasis {
+    static constexpr float tension = (float) TensionNum / Den;
+    static constexpr float continuity = (float) ContinuityNum / Den;
+    static constexpr float bias = (float) BiasNum / Den;
+
+    void coefficients(const vec2 (&p)[4], float (&c)[4]) const {
+        float s01 = splineSlope(p[0], p[1]);
+        float s12 = splineSlope(p[1], p[2]);
+        float s23 = splineSlope(p[2], p[3]);
+        // Outgoing tangent at p1 and incoming tangent at p2
+        float m1 = (1 - tension) * (1 + bias) * (1 + continuity) / 2 * s01
+                 + (1 - tension) * (1 - bias) * (1 - continuity) / 2 * s12;
+        float m2 = (1 - tension) * (1 + bias) * (1 - continuity) / 2 * s12
+                 + (1 - tension) * (1 - bias) * (1 + continuity) / 2 * s23;
+        splineHermite(p, m1, m2, c);
+    }
+};
+
+/**
+ * Uniform cubic B-spline over the y coordinates. Cheaper than the Hermite
+ * bases as it needs no slopes, but it does not pass through the control
+ * points. It is C2 in t only: t runs over each segment at its own rate, so
+ * where neighbouring segments differ in width dy/dx jumps by the ratio of
+ * the widths. Smooth in x only for evenly spaced control points.
+ */
+struct BSplineBasis {
+    void coefficients(const vec2 (&p)[4], float (&c)[4]) const {
+        float g[4] = { p[0].y, p[1].y, p[2].y, p[3].y };
+        splineApplyBasis(bSplineBasis, 1.0f / 6, g, c);
+    }
+};
+
+#endif // SPLINEBASIS_H
@@ -0,0 +1,150 @@
+#ifndef STREAMBUFFER_H
+#define STREAMBUFFER_H
+
+#include <stddef.h>
+
+/**
+ * One big vertex buffer for geometry that changes every frame.
+ *
+ * The buffer is split into `regionCount` regions, one per frame in flight.
+ * Every frame writes into its own region and puts a fence behind it, so the
+ * cpu only waits if it gets `regionCount` frames ahead of the gpu.
+ *
+ * With ARB_buffer_storage the whole buffer is mapped once (persistent and
+ * coherent) and the drawers write straight into it. Without it every write
+ * maps the requested range unsynchronized, which is safe because of the fences.
+ */
+class StreamBuffer {
+
+    static const int regionCount = 3;
+
+    unsigned int vbo;
+    size_t regionSize;
+    bool persistent;
+    char * mapped = NULL; // persistent mapping of the whole buffer
+
+    GLsync fences[regionCount] = { 0 };
+    int region = 0;       // region of the current frame
+    size_t used = 0;      // bytes written into the current region
+    size_t pending = 0;   // size of the range opened by begin()
+
+    void create() {
+        glGenBuffers(1, &vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        size_t size = regionSize * regionCount;
+        if (persistent) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_ARRAY_BUFFER, size, NULL, flags);
+            mapped = (char *) glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+        } else {
+            glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+        }
+    }
+
+    void destroy() {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        if (persistent) glUnmapBuffer(GL_ARRAY_BUFFER);
+        glDeleteBuffers(1, &vbo);
+        mapped = NULL;
+        for (int i = 0; i < regionCount; i++) {
+            if (fences[i]) glDeleteSync(fences[i]);
+            fences[i] = 0;
+        }
+    }
+
+    /**
+     * Called when a frame needs more than one region. Drains the gpu and
+     * recreates the buffer big enough, so the next frames fit again.
+     */
+    void grow(size_t bytes) {
+        glFinish();
+        destroy();
+        while (regionSize < used + bytes) regionSize *= 2;
+        create();
+        // Nothing is in flight any more, start the frame from the beginning
+        used = 0;
+    }
+
+public:
+
+    // Bytes written since the start, the Profiler takes their differences
+    size_t bytesWritten = 0;
+
+    /**
+     * @param regionSize - Bytes available for one frame
+     */
+    StreamBuffer(size_t regionSize = 256 * 1024)
+    :regionSize(regionSize)
+    {
+#if defined(__APPLE__)
+        persistent = false;
+#else
+        persistent = GLEW_ARB_buffer_storage;
+#endif
+        create();
+    }
+
+    unsigned int getId() { return vbo; }
+
+    /**
+     * Call before the first draw of the frame. Waits until the gpu
+     * has finished reading the region we are about to overwrite.
+     */
+    void beginFrame() {
+        GLsync fence = fences[region];
+        if (fence) {
+            GLenum status = glClientWaitSync(fence, 0, 0);
+            while (status == GL_TIMEOUT_EXPIRED) {
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+            }
+            glDeleteSync(fence);
+            fences[region] = 0;
+        }
+        used = 0;
+    }
+
+    /**
+     * Call after the last draw of the frame.
+     */
+    void endFrame() {
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        region = (region + 1) % regionCount;
+    }
+
+    /**
+     * Reserves `bytes` in the current region and binds the buffer to
+     * GL_ARRAY_BUFFER. The returned memory has to be filled before end().
+     */
+    void * begin(size_t bytes) {
+        // Keep every range aligned for floats and vec4s
+        used = (used + 15) & ~(size_t) 15;
+        if (used + bytes > regionSize) grow(bytes);
+        pending = bytes;
+
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        size_t offset = region * regionSize + used;
+        if (persistent) return mapped + offset;
+        return glMapBufferRange(GL_ARRAY_BUFFER, offset, bytes,
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    }
+
+    /**
+     * Closes the range opened by begin().
+     * @return - Byte offset of the range in the buffer, use it as the
+     *           pointer argument of glVertexAttribPointer
+     */
+    size_t end() {
+        if (!persistent) glUnmapBuffer(GL_ARRAY_BUFFER);
+        size_t offset = region * regionSize + used;
+        used += pending;
+        bytesWritten += pending;
+        pending = 0;
+        return offset;
+    }
+
+    virtual ~StreamBuffer() {
+        destroy();
+    }
+};
+
+#endif // STREAMBUFFER_H
@@ -0,0 +1,232 @@
+// Parameter sweep: runs the simulation of a scene headless for every
+// combination of the parameters, on all cores, and writes the metrics of
+// every wheel of every run as CSV.
+//
+// usage: sweep --scene FILE [--tension -0.1,0.2] [--gravity 10] [--air 0.005]
+//              [--ride 1.5] [--angle 0.02] [--steps N] [--threads T] [--out FILE]
+//
+// The lists are the values of the grid, a run is one combination. The
+// scene file has one item per line (# starts a comment):
+//
+//     ground x0 y0 x1 y1       start and end of the ground (default: the middle line of the window)
+//     point x y                control point of the ground
+//     wheel x y radius [left]  a wheel, going right unless `left`
+//
+// Every run builds its own ground, wheels and controllers, nothing is
+// shared between the runs but the parsed scene.
+#include "../src/vecmath.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+vec4 asvec4(vec2 v) {
+    return vec4(v.x, v.y, 0, 1);
+}
+
+vec2 asvec2(vec4 v) {
+    return vec2(v.x, v.y);
+}
+
+#include "../src/log.h"
+#include "../src/renderbackend.h"
+#include "../src/camera.h"
+#include "../src/splinebasis.h"
+#include "../src/spline.h"
+#include "../src/circle.h"
+
+struct Wheel {
+    vec2 center;
+    float radius;
+    bool rightGoing;
+};
+
+struct Scene {
+    vec2 start = vec2(0, windowHeight / 2);
+    vec2 end = vec2(windowWidth, windowHeight / 2);
+    std::vector<vec2> points;
+    std::vector<Wheel> wheels;
+};
+
+struct Run {
+    float tension;
+    RideParams params;
+};
+
+struct Metrics {
+    float distance = 0;    // along the ground, both directions count
+    int turnarounds = 0;   // arrivals at a side, see CircleController::getTurnarounds
+    float maxVelocity = 0; // largest |velocity|
+    float finalX = 0;
+};
+
+static bool loadScene(const char * path, Scene & scene) {
+    FILE * file = fopen(path, "r");
+    if (!file) return false;
+    char line[256];
+    int number = 0;
+    bool ok = true;
+    while (fgets(line, sizeof(line), file)) {
+        number++;
+        char * comment = strchr(line, '#');
+        if (comment) *comment = 0;
+        char item[16] = "", option[16] = "";
+        float a, b, c, d;
+        if (sscanf(line, "%15s", item) != 1) continue; // empty line
+        if (!strcmp(item, "ground") && sscanf(line, "%*s %f %f %f %f", &a, &b, &c, &d) == 4) {
+            scene.start = vec2(a, b);
+            scene.end = vec2(c, d);
+        } else if (!strcmp(item, "point") && sscanf(line, "%*s %f %f", &a, &b) == 2) {
+            scene.points.push_back(vec2(a, b));
+        } else if (!strcmp(item, "wheel") && sscanf(line, "%*s %f %f %f %15s", &a, &b, &c, option) >= 3) {
+            Wheel wheel = { vec2(a, b), c, strcmp(option, "left") != 0 };
+            scene.wheels.push_back(wheel);
+        } else {
+            fprintf(stderr, "%s:%d: cannot read: %s", path, number, line);
+            ok = false;
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+static std::vector<float> parseList(const char * text) {
+    std::vector<float> list;
+    std::string item;
+    for (const char * c = text; ; c++) {
+        if (*c == ',' || *c == 0) {
+            if (!item.empty()) list.push_back(atof(item.c_str()));
+            item.clear();
+            if (*c == 0) break;
+        } else {
+            item += *c;
+        }
+    }
+    return list;
+}
+
+// One run, everything it touches is its own
+static void simulate(const Scene & scene, const Run & run, int steps, Metrics * metrics) {
+    Spline ground(scene.start, scene.end, run.tension);
+    ground.add(scene.points);
+
+    std::vector<Circle *> circles;
+    std::vector<CircleController *> controllers;
+    for (int w = 0; w < scene.wheels.size(); w++) {
+        circles.push_back(new Circle(scene.wheels[w].center, scene.wheels[w].radius));
+        controllers.push_back(new CircleController(circles[w], &ground, scene.wheels[w].rightGoing, run.params));
+    }
+
+    Spline::Reader shape = ground.read();
+    for (int w = 0; w < circles.size(); w++) {
+        Circle * circle = circles[w];
+        CircleController * control = controllers[w];
+        Metrics & m = metrics[w];
+        for (int step = 0; step < steps; step++) {
+            float before = shape->arcLength(circle->center.x);
+            control->tick();
+            m.distance += fabsf(shape->arcLength(circle->center.x) - before);
+            m.maxVelocity = fmaxf(m.maxVelocity, fabsf(control->getVelocity()));
+        }
+        m.turnarounds = control->getTurnarounds();
+        m.finalX = circle->center.x;
+    }
+
+    for (int w = 0; w < circles.size(); w++) {
+        delete controllers[w];
+        delete circles[w];
+    }
+}
+
+int main(int argc, char * argv[]) {
+    const char * scenePath = NULL;
+    const char * outPath = NULL;
+    std::vector<float> tensions(1, -0.1f), gravities(1, 10), airs(1, 0.005f), rides(1, 1.5f), angles(1, 0.02f);
+    int steps = 1000;
+    int threads = std::thread::hardware_concurrency();
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--scene") && i + 1 < argc) scenePath = argv[++i];
+        else if (!strcmp(argv[i], "--tension") && i + 1 < argc) tensions = parseList(argv[++i]);
+        else if (!strcmp(argv[i], "--gravity") && i + 1 < argc) gravities = parseList(argv[++i]);
+        else if (!strcmp(argv[i], "--air") && i + 1 < argc) airs = parseList(argv[++i]);
+        else if (!strcmp(argv[i], "--ride") && i + 1 < argc) rides = parseList(argv[++i]);
+        else if (!strcmp(argv[i], "--angle") && i + 1 < argc) angles = parseList(argv[++i]);
+        else if (!strcmp(argv[i], "--steps") && i + 1 < argc) steps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--out") && i + 1 < argc) outPath = argv[++i];
+        else {
+            scenePath = NULL;
+            break;
+        }
+    }
+    if (!scenePath || tensions.empty() || gravities.empty() || airs.empty() || rides.empty() || angles.empty()) {
+        fprintf(stderr, "usage: %s --scene FILE [--tension -0.1,0.2] [--gravity 10] [--air 0.005]\n"
+                        "       [--ride 1.5] [--angle 0.02] [--steps N] [--threads T] [--out FILE]\n", argv[0]);
+        return 1;
+    }
+    if (threads < 1) threads = 1;
+
+    Scene scene;
+    if (!loadScene(scenePath, scene)) {
+        fprintf(stderr, "Cannot load the scene %s\n", scenePath);
+        return 1;
+    }
+
+    // The grid
+    std::vector<Run> runs;
+    for (int t = 0; t < tensions.size(); t++)
+    for (int g = 0; g < gravities.size(); g++)
+    for (int a = 0; a < airs.size(); a++)
+    for (int r = 0; r < rides.size(); r++)
+    for (int n = 0; n < angles.size(); n++) {
+        Run run;
+        run.tension = tensions[t];
+        run.params.gravity = gravities[g];
+        run.params.airResistance = airs[a];
+        run.params.ride = rides[r];
+        run.params.angleFactor = angles[n];
+        runs.push_back(run);
+    }
+
+    // The workers take the next run until there is none left
+    int wheels = scene.wheels.size();
+    std::vector<Metrics> metrics(runs.size() * wheels);
+    std::atomic<int> next(0);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.push_back(std::thread([&] {
+            for (int i = next++; i < runs.size(); i = next++) {
+                simulate(scene, runs[i], steps, &metrics[i * wheels]);
+            }
+        }));
+    }
+    for (int t = 0; t < threads; t++) workers[t].join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    FILE * out = outPath ? fopen(outPath, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Cannot write %s\n", outPath);
+        return 1;
+    }
+    fprintf(out, "run,tension,gravity,air_resistance,ride,angle_factor,wheel,distance,turnarounds,max_velocity,final_x\n");
+    for (int i = 0; i < runs.size(); i++) {
+        const Run & run = runs[i];
+        for (int w = 0; w < wheels; w++) {
+            const Metrics & m = metrics[i * wheels + w];
+            fprintf(out, "%d,%g,%g,%g,%g,%g,%d,%.3f,%d,%.4f,%.3f\n", i, run.tension, run.params.gravity,
+                    run.params.airResistance, run.params.ride, run.params.angleFactor, w,
+                    m.distance, m.turnarounds, m.maxVelocity, m.finalX);
+        }
+    }
+    if (outPath) fclose(out);
+    fprintf(stderr, "%d runs, %d wheels, %d steps on %d threads in %.2f s\n",
+            (int) runs.size(), wheels, steps, threads, seconds);
+    return 0;
+}
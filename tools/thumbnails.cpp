@@ -0,0 +1,122 @@
+// Preview images of scenes without OpenGL: the drawers draw into a
+// CpuRasterizer and the images are written as TGA files.
+//
+// usage: thumbnails [--count N] [--out DIR] [--threads T] [--no-write]
+//
+// Scene i has a random ground (seeded with i), the background of the
+// application and a wheel put on the ground.
+#include "../src/vecmath.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+vec4 asvec4(vec2 v) {
+    return vec4(v.x, v.y, 0, 1);
+}
+
+vec2 asvec2(vec4 v) {
+    return vec2(v.x, v.y);
+}
+
+#include "../src/log.h"
+#include "../src/renderbackend.h"
+#include "../src/cpurasterizer.h"
+#include "../src/camera.h"
+#include "../src/splinebasis.h"
+#include "../src/spline.h"
+#include "../src/circle.h"
+
+typedef std::chrono::steady_clock Clock;
+
+int main(int argc, char * argv[]) {
+    int count = 100;
+    std::string out = "thumbnails";
+    int threads = 1;
+    bool write = true;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--count") && i + 1 < argc) count = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--out") && i + 1 < argc) out = argv[++i];
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--no-write")) write = false;
+        else {
+            fprintf(stderr, "usage: %s [--count N] [--out DIR] [--threads T] [--no-write]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (write) {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+        _mkdir(out.c_str());
+#else
+        mkdir(out.c_str(), 0755);
+#endif
+    }
+
+    CpuRasterizer rasterizer(windowWidth, windowHeight, threads);
+    Camera camera(vec2(windowWidth / 2, windowHeight / 2), windowWidth, windowHeight);
+    GroundDrawer groundDrawer(&rasterizer);
+    CircleDrawer circleDrawer(&rasterizer);
+
+    // The background of the application
+    BgSpline bg(vec2(0, 2 * windowHeight / 3), vec2(windowWidth, 3 * windowHeight / 4));
+    bg.add(vec2(150, 550));
+    bg.add(vec2(300, 500));
+    bg.add(vec2(450, 575));
+    BgDrawer bgDrawer(&bg, &rasterizer);
+    std::vector<float> groundVertices, circleVertices;
+
+    double sceneMs = 0, rasterMs = 0, writeMs = 0;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < count; i++) {
+        Clock::time_point phase = Clock::now();
+        srand(i);
+        Spline ground(vec2(0, windowHeight / 2), vec2(windowWidth, windowHeight / 2), -0.1);
+        int points = 2 + rand() % 6;
+        int spacing = (windowWidth - 40) / points;
+        for (int p = 0; p < points; p++) {
+            // One point per slot, so no two share an x
+            ground.add(vec2(20 + p * spacing + rand() % (spacing - 1) + 1, windowHeight / 6 + rand() % (windowHeight / 2)));
+        }
+        Circle circle(vec2(40 + rand() % (windowWidth - 80), 0), 30);
+        CircleController(&circle, &ground).tick();
+        GroundDrawer::generate(&ground, groundVertices);
+        CircleDrawer::generate(&circle, circleVertices, camera.getPixelsPerUnit());
+        sceneMs += std::chrono::duration<double, std::milli>(Clock::now() - phase).count();
+
+        phase = Clock::now();
+        rasterizer.clear(vec3(0, 0, 0));
+        rasterizer.setViewProjection(camera.getMatrix());
+        bgDrawer.draw(camera.getMatrix());
+        groundDrawer.draw(groundVertices);
+        circleDrawer.draw(circleVertices);
+        rasterizer.flush();
+        rasterMs += std::chrono::duration<double, std::milli>(Clock::now() - phase).count();
+
+        if (write) {
+            phase = Clock::now();
+            char name[32];
+            sprintf(name, "/thumb_%05d.tga", i);
+            if (!rasterizer.writeTga((out + name).c_str())) {
+                fprintf(stderr, "Cannot write %s%s\n", out.c_str(), name);
+                return 1;
+            }
+            writeMs += std::chrono::duration<double, std::milli>(Clock::now() - phase).count();
+        }
+    }
+    double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    printf("%d thumbnails %dx%d, %d threads: %.1f per second\n", count, windowWidth, windowHeight, threads,
+            count / (totalMs / 1000));
+    printf("per thumbnail: scene %.3f ms, raster %.3f ms, write %.3f ms\n",
+            sceneMs / count, rasterMs / count, writeMs / count);
+    return 0;
+}